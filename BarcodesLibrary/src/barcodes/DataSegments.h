@@ -50,6 +50,8 @@ namespace barcodes {
 	class DataSegments:public vector<DataSegment> {
 	public:
 		static const int DATA_SEGMENTS_CORRUPTED = 0x01; /**< Some segments might be corrupted. */
+		static const int DATA_SEGMENTS_DEADLINE_EXCEEDED = 0x02; /**< Deadline has expired, some stages have been skipped. */
+		static const int DATA_SEGMENTS_MIRRORED = 0x04; /**< Code has been read mirrored (e.g. from the back of the film). */
 		int flags;				/**< Flags which informs about how whole decode process finished */
 
 		DataSegments() : flags(0) {}
@@ -0,0 +1,58 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       DecodeContext.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines DecodeContext class which holds the mutable state
+//             of one decoding.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DecodeContext.h
+ *
+ * @brief Defines DecodeContext class which holds the mutable state
+ *        of one decoding.
+ * @author agent agent(at)local
+ */
+
+#ifndef DECODECONTEXT_H_
+#define DECODECONTEXT_H_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "../common/Image.h"
+#include "DetectContext.h"
+
+namespace barcodes {
+using namespace std;
+using namespace cv;
+
+/**
+ * Mutable state of one decoding, decoders themselves are immutable. Every thread
+ * which decodes at once has to use its own context, the context can be reused
+ * for the next decodings of the same thread.
+ */
+class DecodeContext {
+public:
+	DetectContext detectContext; /**< Context of the detection of the decoded image */
+	Mat warpedImage;			 /**< Last processed (warped and binarized) image of the barcode */
+	vector<Point> corners;		 /**< Perspective corners of the last processed barcode */
+
+	DecodeContext() {}
+	virtual ~DecodeContext() {}
+
+	/**
+	 * Returns last processed image during reading.
+	 *
+	 * @return Last processed image during reading.
+	 */
+	Image lastProcessedImage() const {
+		return Image(warpedImage, IMAGE_COLOR_GRAYSCALE);
+	}
+};
+
+} /* namespace barcodes */
+#endif /* DECODECONTEXT_H_ */
@@ -0,0 +1,53 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       DecodedSymbol.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines DecodedSymbol class which holds the data and location
+//             of one decoded barcode of the image.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DecodedSymbol.h
+ *
+ * @brief Defines DecodedSymbol class which holds the data and location
+ *        of one decoded barcode of the image.
+ * @author agent agent(at)local
+ */
+
+#ifndef DECODEDSYMBOL_H_
+#define DECODEDSYMBOL_H_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "DataSegments.h"
+#include "DetectedMarks.h"
+
+namespace barcodes {
+using namespace std;
+using namespace cv;
+
+/**
+ * One decoded barcode of the image which can contain more barcodes.
+ */
+class DecodedSymbol {
+public:
+	DataSegments dataSegments;	/**< Decoded data segments of the barcode */
+	DetectedMarks detectedMarks;/**< Localization marks of the barcode */
+	vector<Point> corners;		/**< Perspective corners of the barcode in the image */
+
+	virtual ~DecodedSymbol() {}
+};
+
+/**
+ * All decoded barcodes of the image.
+ *
+ * @see DecodedSymbol
+ */
+typedef vector<DecodedSymbol> DecodedSymbols;
+
+} /* namespace barcodes */
+#endif /* DECODEDSYMBOL_H_ */
@@ -0,0 +1,42 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       DetectContext.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Implements member methods of DetectContext class which holds
+//             the mutable state of one detection.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DetectContext.cpp
+ *
+ * @brief Implements member methods of DetectContext class which holds
+ *        the mutable state of one detection.
+ * @author agent agent(at)local
+ */
+
+#include "DetectContext.h"
+
+namespace barcodes {
+
+/**
+ * Reserves the range of the contour indices (variants of the marks). Ranges are
+ * reserved atomically, so the parallel tasks of the detection get distinct ranges.
+ *
+ * @param count Number of the reserved indices.
+ * @return Offset of the reserved range.
+ */
+int DetectContext::reserveContourOffset(int count) {
+	return __sync_fetch_and_add(&contourOffset, count);
+}
+
+/**
+ * Resets the context before the next detection.
+ */
+void DetectContext::reset() {
+	contourOffset = 0;
+}
+
+} /* namespace barcodes */
@@ -0,0 +1,54 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       DetectContext.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines DetectContext class which holds the mutable state
+//             of one detection.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file DetectContext.h
+ *
+ * @brief Defines DetectContext class which holds the mutable state
+ *        of one detection.
+ * @author agent agent(at)local
+ */
+
+#ifndef DETECTCONTEXT_H_
+#define DETECTCONTEXT_H_
+
+namespace barcodes {
+
+/**
+ * Mutable state of one detection, detectors themselves are immutable. Every thread
+ * which detects at once has to use its own context, the context can be reused
+ * for the next detections of the same thread. Parallel tasks of one detection
+ * share the context of the detection.
+ */
+class DetectContext {
+public:
+	DetectContext() : contourOffset(0) {}
+	virtual ~DetectContext() {}
+
+	/**
+	 * Reserves the range of the contour indices (variants of the marks). Ranges are
+	 * reserved atomically, so the parallel tasks of the detection get distinct ranges.
+	 *
+	 * @param count Number of the reserved indices.
+	 * @return Offset of the reserved range.
+	 */
+	int reserveContourOffset(int count);
+
+	/**
+	 * Resets the context before the next detection.
+	 */
+	void reset();
+protected:
+	int contourOffset; /**< Offset of the next unreserved contour index */
+};
+
+} /* namespace barcodes */
+#endif /* DETECTCONTEXT_H_ */
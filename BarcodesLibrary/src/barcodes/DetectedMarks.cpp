@@ -17,6 +17,7 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
+#include <algorithm>
 #include <opencv2/imgproc/imgproc.hpp>
 
 #include "DetectedMarks.h"
@@ -25,33 +26,76 @@
 namespace barcodes {
 
 /**
- * Filters detected marks which too close.
+ * Margin of the sweep range which covers rounding of the centers.
+ */
+static const float FILTER_SWEEP_MARGIN = 2;
+
+/**
+ * Returns the minimal area rectangle of the points. It is cached
+ * and calculated again only if the points have been changed.
+ *
+ * @return Minimal area rectangle of the points.
+ */
+const RotatedRect &DetectedMark::getBox() const {
+	if ((boxPoints.empty()) || (boxPoints != points)) {
+		box = minAreaRect(Mat(points));
+		boxPoints = points;
+	}
+	return box;
+}
+
+/**
+ * Filters detected marks which too close. Every kept mark, in the order of the marks, removes
+ * all other marks close to it. Close marks are found by the sweep over the x coordinates of the centers.
+ * The former loop restarted after every removal and removed also the mark which had removed
+ * some mark after the first one, such marks are kept now.
  *
  * @param centerPointsMinDistance Minimal possible allowed distance ratio between centers of the marks.
  *        Minimal distance is calculated as a product of multiplying sizes of bounding rectangle and this ratio.
  */
 void DetectedMarks::filter(double centerPointsMinDistance) {
+	int count = this->size();
+	if (count < 2) return;
+
+	// Centers are calculated as a centers of bounding rectangles.
+	vector<pair<float, int> > sweep(count);
+	for (int i = 0; i < count; i++) {
+		sweep[i] = make_pair((*this)[i].getBox().center.x, i);
+	}
+	sort(sweep.begin(), sweep.end());
 
-	vector<DetectedMark>::iterator iter, iter2;
+	vector<uchar> removed(count, 0);
+	for (int i = 0; i < count; i++) {
+		if (removed[i]) continue;
 
-	for (iter = this->begin(); iter != this->end(); iter++) {
-		// Centers are calculated as a centers of bounding rectangles.
-		RotatedRect refMarkBox = minAreaRect(Mat(iter->points));
-		for (iter2 = this->begin(); iter2 != this->end(); ) {
-			RotatedRect markBox = minAreaRect(Mat(iter2->points));
-			Vector2D centerDiff(refMarkBox.center, markBox.center);
-
-			if ((iter != iter2)
-				&& (fabs(centerDiff.dx) / (double)refMarkBox.boundingRect().width < centerPointsMinDistance)
-				&& (fabs(centerDiff.dy) / (double)refMarkBox.boundingRect().height < centerPointsMinDistance)
+		const RotatedRect &refMarkBox = (*this)[i].getBox();
+		Rect refMarkRect = refMarkBox.boundingRect();
+
+		// Only marks in this range of x can be too close, centers are compared rounded
+		float maxDx = refMarkRect.width * centerPointsMinDistance + FILTER_SWEEP_MARGIN;
+		vector<pair<float, int> >::iterator iter = lower_bound(sweep.begin(), sweep.end(),
+				make_pair(refMarkBox.center.x - maxDx, -1));
+
+		for (; (iter != sweep.end()) && (iter->first <= refMarkBox.center.x + maxDx); iter++) {
+			int j = iter->second;
+			if ((j == i) || removed[j]) continue;
+
+			Vector2D centerDiff(refMarkBox.center, (*this)[j].getBox().center);
+			if ((fabs(centerDiff.dx) / (double)refMarkRect.width < centerPointsMinDistance)
+				&& (fabs(centerDiff.dy) / (double)refMarkRect.height < centerPointsMinDistance)
 			)  { // This mark is too close, filter it
-					iter2 = this->erase(iter2);
-					iter = this->begin();
-			} else {
-				iter2++;
+				removed[j] = 1;
 			}
 		}
 	}
+
+	int kept = 0;
+	for (int i = 0; i < count; i++) {
+		if (removed[i]) continue;
+		if (kept != i) (*this)[kept] = (*this)[i];
+		kept++;
+	}
+	this->erase(this->begin() + kept, this->end());
 }
 
 /**
@@ -77,6 +121,13 @@ void DetectedMarks::perspectiveTransform(Mat &transformation) {
 		for (unsigned int i = 0; i < points2f.size(); i++) {
 			iter->points.push_back(res.at<Point2f>(i, 0));
 		}
+
+		if (!iter->refinedPoints.empty()) {
+			cv::perspectiveTransform(Mat(iter->refinedPoints), res, transformation);
+			for (unsigned int i = 0; i < iter->refinedPoints.size(); i++) {
+				iter->refinedPoints[i] = res.at<Point2f>(i, 0);
+			}
+		}
 	}
 }
 
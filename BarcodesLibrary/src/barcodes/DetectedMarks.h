@@ -23,6 +23,7 @@
 #include <opencv2/core/core.hpp>
 
 namespace barcodes {
+using namespace std;
 using namespace cv;
 
 /**
@@ -31,13 +32,26 @@ using namespace cv;
 class DetectedMark {
 public:
 	vector<Point> points; /**< Points of the mark */
+	vector<Point2f> refinedPoints; /**< Points of the mark in subpixel precision (same order), empty if not refined */
 	double match;		  /**< Match ratio and possibility that this is the mark */
 	int flags;			  /**< Flags/Conditions in which has been detected this mark */
 	int variant;/**< Variant object attribute, it can serve for passing int value or pointer etc. */
+	int attempt;		  /**< Repair and distance flags of the scheduled attempt which has detected this mark, -1 if not scheduled */
 
-	DetectedMark() : match(0), flags(0), variant(0) {}
+	DetectedMark() : match(0), flags(0), variant(0), attempt(-1) {}
 
 	virtual ~DetectedMark() {}
+
+	/**
+	 * Returns the minimal area rectangle of the points. It is cached
+	 * and calculated again only if the points have been changed.
+	 *
+	 * @return Minimal area rectangle of the points.
+	 */
+	const RotatedRect &getBox() const;
+protected:
+	mutable vector<Point> boxPoints; /**< Points for which has been calculated the cached box */
+	mutable RotatedRect box;		 /**< Cached minimal area rectangle of the points */
 };
 
 /**
@@ -50,7 +64,10 @@ public:
 	virtual ~DetectedMarks() {}
 
 	/**
-	 * Filters detected marks which too close.
+	 * Filters detected marks which too close. Every kept mark, in the order of the marks, removes
+	 * all other marks close to it. Close marks are found by the sweep over the x coordinates of the centers.
+	 * The former loop restarted after every removal and removed also the mark which had removed
+	 * some mark after the first one, such marks are kept now.
 	 *
 	 * @param centerPointsMinDistance Minimal possible allowed distance ratio between centers of the marks.
 	 *        Minimal distance is calculated as a product of multiplying sizes of bounding rectangle and this ratio.
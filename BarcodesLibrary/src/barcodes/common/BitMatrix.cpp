@@ -91,6 +91,27 @@ void BitMatrix::pushRow(BitArray &rowArr) {
 	}
 }
 
+/**
+ * Transposes bit matrix in place. Square matrix is transposed by swapping
+ * the bits across the main diagonal, without any allocation.
+ */
+void BitMatrix::transpose() {
+	if (rows != cols) {
+		Base transposed;
+		cv::transpose(*this, transposed);
+		Base::operator=(transposed);
+		return;
+	}
+
+	for (int row = 1; row < rows; row++) {
+		for (int col = 0; col < row; col++) {
+			bool bit = at(row, col);
+			at(row, col) = at(col, row);
+			at(col, row) = bit;
+		}
+	}
+}
+
 /**
  * Clears bit matrix.
  */
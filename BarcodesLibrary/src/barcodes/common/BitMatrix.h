@@ -140,6 +140,12 @@ public:
 	 */
 	void removeCol(int col);
 
+	/**
+	 * Transposes bit matrix in place. Square matrix is transposed by swapping
+	 * the bits across the main diagonal, without any allocation.
+	 */
+	void transpose();
+
 	/**
 	 * Clears bit matrix.
 	 */
@@ -34,6 +34,19 @@ void QrBarcode::detect(Image &image, DetectedMarks &detectedMarks, int flags) {
 	QrDetector::getInstance()->detect(image, detectedMarks, flags);
 }
 
+/**
+ * Detects QR code only inside the regions of the image (with the margin)
+ * and returns localization marks in the coordinates of the whole image.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param regions Regions of the image where the QR code can be.
+ * @param flags Detection flags.
+ */
+void QrBarcode::detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, int flags) {
+	QrDetector::getInstance()->detect(image, detectedMarks, regions, flags);
+}
+
 /**
  * Decodes QR code on the image and returns decoded data segments.
  *
@@ -45,6 +58,59 @@ void QrBarcode::decode(Image &image, DataSegments &dataSegments, int flags) {
 	QrDecoder::getInstance()->decode(image, dataSegments, flags);
 }
 
+/**
+ * Decodes QR code on the image until the deadline and returns decoded data segments.
+ * The best result so far is returned and DataSegments::DATA_SEGMENTS_DEADLINE_EXCEEDED
+ * flag is set if the deadline has expired before all stages were tried.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param deadline Deadline of the decoding, e.g. Deadline(budget) for the time budget [ms].
+ * @param flags Flags used for detection and decoding.
+ */
+void QrBarcode::decode(Image &image, DataSegments &dataSegments, const Deadline &deadline, int flags) {
+	QrDecoder::getInstance()->decode(image, dataSegments, deadline, flags);
+}
+
+/**
+ * Decodes QR code on the image and returns decoded data segments. The context
+ * holds all mutable state of the decoding and the last processed image, so more
+ * threads can decode at once, each of them with its own context.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param context Context of the decoding.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrBarcode::decode(Image &image, DataSegments &dataSegments, DecodeContext &context, int flags) {
+	QrDecoder::getInstance()->decode(image, dataSegments, context, Deadline(), flags);
+}
+
+/**
+ * Decodes QR code only inside the regions of the image (with the margin)
+ * and returns decoded data segments.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param regions Regions of the image where the QR code can be.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrBarcode::decode(Image &image, DataSegments &dataSegments, const vector<Rect> &regions, int flags) {
+	DecodeContext context;
+	QrDecoder::getInstance()->decode(image, dataSegments, regions, context, Deadline(), flags);
+}
+
+/**
+ * Decodes all QR codes on the image and returns decoded symbols with their locations.
+ *
+ * @param image Image with the QR codes.
+ * @param symbols Result decoded symbols.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrBarcode::decode(Image &image, DecodedSymbols &symbols, int flags) {
+	QrDecoder::getInstance()->decode(image, symbols, flags);
+}
+
 }
 
 
@@ -45,7 +45,20 @@ namespace barcodes {
 		 */
 		static void detect(Image &image, DetectedMarks &detectedMarks, int flags = QrDetector::FLAG_ADAPT_THRESH |
 				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
-				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL);
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
+
+		/**
+		 * Detects QR code only inside the regions of the image (with the margin)
+		 * and returns localization marks in the coordinates of the whole image.
+		 *
+		 * @param image Image with the QR code.
+		 * @param detectedMarks Recognized localization marks.
+		 * @param regions Regions of the image where the QR code can be.
+		 * @param flags Detection flags.
+		 */
+		static void detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, int flags = QrDetector::FLAG_ADAPT_THRESH |
+				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
 
 		/**
 		 * Decodes QR code on the image and returns decoded data segments.
@@ -56,7 +69,60 @@ namespace barcodes {
 		 */
 		static void decode(Image &image, DataSegments &dataSegments, int flags = QrDetector::FLAG_ADAPT_THRESH |
 				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
-				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL);
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
+
+		/**
+		 * Decodes QR code on the image until the deadline and returns decoded data segments.
+		 * The best result so far is returned and DataSegments::DATA_SEGMENTS_DEADLINE_EXCEEDED
+		 * flag is set if the deadline has expired before all stages were tried.
+		 *
+		 * @param image Image with the QR code.
+		 * @param dataSegments Result decoded data segments.
+		 * @param deadline Deadline of the decoding, e.g. Deadline(budget) for the time budget [ms].
+		 * @param flags Flags used for detection and decoding.
+		 */
+		static void decode(Image &image, DataSegments &dataSegments, const Deadline &deadline, int flags = QrDetector::FLAG_ADAPT_THRESH |
+				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
+
+		/**
+		 * Decodes QR code on the image and returns decoded data segments. The context
+		 * holds all mutable state of the decoding and the last processed image, so more
+		 * threads can decode at once, each of them with its own context.
+		 *
+		 * @param image Image with the QR code.
+		 * @param dataSegments Result decoded data segments.
+		 * @param context Context of the decoding.
+		 * @param flags Flags used for detection and decoding.
+		 */
+		static void decode(Image &image, DataSegments &dataSegments, DecodeContext &context, int flags = QrDetector::FLAG_ADAPT_THRESH |
+				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
+
+		/**
+		 * Decodes QR code only inside the regions of the image (with the margin)
+		 * and returns decoded data segments.
+		 *
+		 * @param image Image with the QR code.
+		 * @param dataSegments Result decoded data segments.
+		 * @param regions Regions of the image where the QR code can be.
+		 * @param flags Flags used for detection and decoding.
+		 */
+		static void decode(Image &image, DataSegments &dataSegments, const vector<Rect> &regions, int flags = QrDetector::FLAG_ADAPT_THRESH |
+				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER);
+
+		/**
+		 * Decodes all QR codes on the image and returns decoded symbols with their locations.
+		 *
+		 * @param image Image with the QR codes.
+		 * @param symbols Result decoded symbols.
+		 * @param flags Flags used for detection and decoding.
+		 */
+		static void decode(Image &image, DecodedSymbols &symbols, int flags = QrDetector::FLAG_ADAPT_THRESH |
+				QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR |
+				QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER |
+				QrDetector::FLAG_PARALLEL_DECODING);
 	};
 
 } /* namespace barcodes */
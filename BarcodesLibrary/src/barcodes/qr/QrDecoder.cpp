@@ -25,26 +25,77 @@
 #include "QrVersionInformation.h"
 #include "QrFormatInformation.h"
 #include "../../common/miscellaneous.h"
+#include "../../common/Polygon2D.h"
 #include "../../debug.h"
 #include "bitdecoder/QrBitDecoder.h"
 #include "QrCodewordOrganizer.h"
+#include "QrDetectionScheduler.h"
+#include "QrMarkGrouper.h"
+#include "../../common/ThreadPool.h"
 #include "perspcorners/PerspCornersFromLineSampling.h"
 #include "perspcorners/PerspCornersFromAlignmentPattern.h"
 #include "perspcorners/PerspCornersFromFinderPattern.h"
+#include "perspcorners/PerspCornersHelper.h"
 
 #define DEBUG_TAG "QrDecoder.cpp"
 
 namespace barcodes {
 
-static PerspCornersFromLineSampling perspCornersFromLineSampling;
-static PerspCornersFromAlignmentPattern perspCornersFromAlignmentPattern;
-static PerspCornersFromFinderPattern perspCornersFromFinderPattern;
+static const PerspCornersFromLineSampling perspCornersFromLineSampling;
+static const PerspCornersFromAlignmentPattern perspCornersFromAlignmentPattern;
+static const PerspCornersFromFinderPattern perspCornersFromFinderPattern;
 
 /**
  * Instance of the QR decoder.
  */
 const QrDecoder QrDecoder::DECODER_INSTANCE = QrDecoder();
 
+/**
+ * Task which decodes the groups of the marks, every group with its own context.
+ */
+class QrDecoder::SymbolsTask : public ParallelTask {
+public:
+	SymbolsTask(const QrDecoder &decoder, Image &image, ThresholdCache &thresholdCache, const Deadline &deadline,
+			vector<DetectedMarks> &groups, int flags) : decoder(decoder), image(image), thresholdCache(thresholdCache),
+			deadline(deadline), groups(groups), flags(flags) {
+		symbols.resize(groups.size());
+	}
+
+	void getSymbols(DecodedSymbols &decodedSymbols) const {
+		decodedSymbols.clear();
+		for (unsigned int i = 0; i < symbols.size(); i++) {
+			if (symbols[i].dataSegments.size() > 0) decodedSymbols.push_back(symbols[i]);
+		}
+	}
+
+	void run(int from, int to) {
+		for (int i = from; i < to; i++) {
+			if (deadline.isExpired()) continue;
+
+			DecodeContext context;
+			DecodedSymbol &symbol = symbols[i];
+			decoder.read_V1_40(image, symbol.dataSegments, groups[i], thresholdCache, context, deadline);
+
+			if (symbol.dataSegments.size() > 0) {
+				symbol.detectedMarks = groups[i];
+				symbol.corners = context.corners;
+
+				if (flags & QrDetector::FLAG_ADAPTIVE_SCHEDULING) {
+					QrDetectionScheduler::getInstance()->recordSuccess(groups[i]);
+				}
+			}
+		}
+	}
+protected:
+	const QrDecoder &decoder;
+	Image &image;
+	ThresholdCache &thresholdCache;
+	const Deadline &deadline;
+	vector<DetectedMarks> &groups;
+	int flags;
+	DecodedSymbols symbols;
+};
+
 /**
  * The size of the sampling grid for retrieving the data from the bit matrix.
  */
@@ -58,11 +109,62 @@ const Size QrDecoder::CODEWORD_SAMPLE_SIZE(2, 4);
  * @param flags Flags used for detection and decoding.
  */
 void QrDecoder::decode(Image &image, DataSegments &dataSegments, int flags) const {
+	decode(image, dataSegments, Deadline(), flags);
+}
+
+/**
+ * Decodes QR code on the image until the deadline and returns decoded data segments.
+ * Deadline is checked before every detection stage and perspective corners strategy,
+ * the best result so far is returned and DATA_SEGMENTS_DEADLINE_EXCEEDED flag is set
+ * if some of them has been skipped.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param deadline Deadline of the decoding.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrDecoder::decode(Image &image, DataSegments &dataSegments, const Deadline &deadline, int flags) const {
+	DecodeContext context;
+	decode(image, dataSegments, context, deadline, flags);
+}
+
+/**
+ * Decodes QR code on the image until the deadline and returns decoded data segments.
+ * All mutable state of the decoding is kept in the context, so more threads
+ * can decode at once, each of them with its own context.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param context Context of the decoding, it holds also the last processed image.
+ * @param deadline Deadline of the decoding.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrDecoder::decode(Image &image, DataSegments &dataSegments, DecodeContext &context, const Deadline &deadline, int flags) const {
 	DEBUG_PRINT(DEBUG_TAG, ">>>>>>>>>>> DECODE START <<<<<<<<<<<<<");
 	DetectedMarks detectedMarks;
+	ThresholdCache thresholdCache(image, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
 	DEBUG_PRINT(DEBUG_TAG, "start time [ms]: %d", DIFF_TIME());
-	QrDetector::getInstance()->detect(image, detectedMarks, flags);
+	QrDetector::getInstance()->detect(image, detectedMarks, thresholdCache, context.detectContext, deadline, flags);
 	DEBUG_PRINT(DEBUG_TAG, "detect [ms]: %d", DIFF_TIME());
+	decodeMarks(image, dataSegments, detectedMarks, thresholdCache, context, deadline, flags);
+	DEBUG_PRINT(DEBUG_TAG, ">>>>>>>>>>> DECODE END <<<<<<<<<<<<<");
+}
+
+/**
+ * Decodes QR code from the already detected marks and returns decoded data segments.
+ * Marks of the same parent contour are preferred, otherwise the best ranked triples
+ * of the marks are decoded in the order of their rank.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param detectedMarks The localization marks, they are reduced to the marks used for decoding.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the decoding, it holds also the last processed image.
+ * @param deadline Deadline of the decoding.
+ * @param flags Flags used for detection and decoding.
+ */
+void QrDecoder::decodeMarks(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+		DecodeContext &context, const Deadline &deadline, int flags) const {
 	map<int,int> parentContourOccurances;
 	bool foundThreeOnSameParentLevel = false;
 	int parentIndex = 0;;
@@ -93,12 +195,168 @@ void QrDecoder::decode(Image &image, DataSegments &dataSegments, int flags) cons
 					_detectedMarks.push_back(detectedMarks[i]);
 				}
 			}
-			read_V1_40(image, dataSegments, _detectedMarks);
-		} else { // There are no three marks on the same parent level, just try luck
-			read_V1_40(image, dataSegments, detectedMarks);
+			detectedMarks = _detectedMarks;
+		} // There are no three marks on the same parent level, triples are ranked
+
+		// If there are no consistent triples, just try luck
+		if (foundThreeOnSameParentLevel || (detectedMarks.size() == 3)
+				|| !readRankedTriples(image, dataSegments, detectedMarks, thresholdCache, context, deadline)) {
+			read_V1_40(image, dataSegments, detectedMarks, thresholdCache, context, deadline);
+		}
+
+		// Attempts which have found the decoded marks are preferred next time
+		if ((flags & QrDetector::FLAG_ADAPTIVE_SCHEDULING) && (dataSegments.size() > 0)) {
+			QrDetectionScheduler::getInstance()->recordSuccess(detectedMarks);
+		}
+	}
+
+	if (deadline.isExceeded()) {
+		dataSegments.flags |= DataSegments::DATA_SEGMENTS_DEADLINE_EXCEEDED;
+	}
+}
+
+/**
+ * Decodes the best ranked triples of the marks in the order of their rank until
+ * the QR code is decoded without the corruption.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param detectedMarks The localization marks, they are reduced to the triple used for decoding.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the decoding.
+ * @param deadline Deadline of the decoding, checked before every triple.
+ * @return False if there is no consistent triple of the marks.
+ *
+ * @see QrMarkGrouper::rankTriples
+ */
+bool QrDecoder::readRankedTriples(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+		DecodeContext &context, const Deadline &deadline) const {
+	vector<QrMarkGrouper::Triple> triples;
+	QrMarkGrouper::rankTriples(detectedMarks, thresholdCache, triples);
+	DEBUG_PRINT(DEBUG_TAG, "ranked triples: %d", triples.size());
+	if (triples.empty()) return false;
+
+	DataSegments bestReadSegments;
+	DetectedMarks bestMarks;
+	for (unsigned int i = 0; (i < triples.size()) && (i < (unsigned int)TRIPLE_DECODE_ATTEMPTS); i++) {
+		if (deadline.isExpired()) break;
+
+		DetectedMarks _detectedMarks;
+		_detectedMarks.push_back(detectedMarks[triples[i].corner]);
+		_detectedMarks.push_back(detectedMarks[triples[i].ends[0]]);
+		_detectedMarks.push_back(detectedMarks[triples[i].ends[1]]);
+
+		read_V1_40(image, dataSegments, _detectedMarks, thresholdCache, context, deadline);
+		if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
+			detectedMarks = _detectedMarks;
+			return true;
+		} else if ((dataSegments.size() > 0) && (bestReadSegments.size() == 0)) {
+			bestReadSegments = dataSegments;
+			bestMarks = _detectedMarks;
+		}
+	}
+
+	dataSegments = bestReadSegments;
+	if (!bestMarks.empty()) detectedMarks = bestMarks;
+	return true;
+}
+
+/**
+ * Decodes QR code only inside the regions of the image (with the margin) until the deadline
+ * and returns decoded data segments. Detection and sampling are done only in the regions,
+ * regions are tried in the order until the QR code is decoded without the corruption.
+ *
+ * @param image Image with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param regions Regions of the image where the QR code can be.
+ * @param context Context of the decoding, it holds also the last processed image,
+ * its corners are in the coordinates of the image.
+ * @param deadline Deadline of the decoding, checked also before every region.
+ * @param flags Flags used for detection and decoding.
+ *
+ * @see QrDetector::getSearchRegion
+ */
+void QrDecoder::decode(Image &image, DataSegments &dataSegments, const vector<Rect> &regions, DecodeContext &context,
+		const Deadline &deadline, int flags) const {
+	DataSegments bestReadSegments;
+	vector<Point> bestCorners;
+
+	for (unsigned int i = 0; i < regions.size(); i++) {
+		Rect searchRegion = QrDetector::getSearchRegion(regions[i], Size(image.cols, image.rows));
+		if (searchRegion.area() == 0) continue;
+		if (deadline.isExpired()) break;
+
+		// Region shares the data with the image, QR code is read in the coordinates of the region
+		Image regionImage(((Mat &)image)(searchRegion), image.getColorFormat());
+		dataSegments = DataSegments();
+		decode(regionImage, dataSegments, context, deadline, flags);
+		Polygon2D::offset(context.corners, searchRegion.tl());
+		if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
+			return;
+		} else if (dataSegments.size() > 0) {
+			bestReadSegments = dataSegments;
+			bestCorners = context.corners;
+		}
+	}
+
+	dataSegments = bestReadSegments;
+	context.corners = bestCorners;
+	if (deadline.isExceeded()) {
+		dataSegments.flags |= DataSegments::DATA_SEGMENTS_DEADLINE_EXCEEDED;
+	}
+}
+
+/**
+ * Decodes all QR codes on the image and returns decoded symbols with their locations.
+ * Marks are grouped into the consistent triples and every group is decoded.
+ *
+ * @param image Image with the QR codes.
+ * @param symbols Result decoded symbols.
+ * @param flags Flags used for detection and decoding.
+ *
+ * @see QrMarkGrouper
+ */
+void QrDecoder::decode(Image &image, DecodedSymbols &symbols, int flags) const {
+	DecodeContext context;
+	decode(image, symbols, context, Deadline(), flags);
+}
+
+/**
+ * Decodes all QR codes on the image until the deadline and returns decoded symbols
+ * with their locations. Marks are grouped into the consistent triples and every group
+ * is decoded, concurrently if FLAG_PARALLEL_DECODING is set.
+ *
+ * @param image Image with the QR codes.
+ * @param symbols Result decoded symbols.
+ * @param context Context of the decoding, it holds the context of the detection.
+ * @param deadline Deadline of the decoding, checked also before every group.
+ * @param flags Flags used for detection and decoding.
+ *
+ * @see QrMarkGrouper
+ */
+void QrDecoder::decode(Image &image, DecodedSymbols &symbols, DecodeContext &context, const Deadline &deadline, int flags) const {
+	DetectedMarks detectedMarks;
+	vector<DetectedMarks> groups;
+	ThresholdCache thresholdCache(image, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
+
+	QrDetector::getInstance()->detect(image, detectedMarks, thresholdCache, context.detectContext, deadline, flags);
+	QrMarkGrouper::groupMarks(detectedMarks, groups);
+	DEBUG_PRINT(DEBUG_TAG, "marks: %d, groups: %d", detectedMarks.size(), groups.size());
+
+	// Groups share only the immutable image and the synchronized threshold cache
+	SymbolsTask task(*this, image, thresholdCache, deadline, groups, flags);
+	if ((flags & QrDetector::FLAG_PARALLEL_DECODING) && (groups.size() > 1)) {
+		ThreadPool::getInstance()->parallelFor(0, groups.size(), 1, task);
+	} else {
+		task.run(0, groups.size());
+	}
+	task.getSymbols(symbols);
+
+	if (deadline.isExceeded()) {
+		for (unsigned int i = 0; i < symbols.size(); i++) {
+			symbols[i].dataSegments.flags |= DataSegments::DATA_SEGMENTS_DEADLINE_EXCEEDED;
 		}
 	}
-	DEBUG_PRINT(DEBUG_TAG, ">>>>>>>>>>> DECODE END <<<<<<<<<<<<<");
 }
 
 /**
@@ -110,14 +368,10 @@ const QrDecoder *QrDecoder::getInstance() {
 	return &DECODER_INSTANCE;
 }
 
-Image QrDecoder::lastProcessedImage() const {
-	return Image(warpedImage, IMAGE_COLOR_GRAYSCALE);
-}
-
-int getMaxSize(vector<Point> corners) {
+int getMaxSize(vector<Point2f> corners) {
 	int max = 0;
 	for (unsigned int i = 1; i < corners.size(); i++) {
-		Vector2D vec(corners[i - 1], corners[i]);
+		Vector2Df vec(corners[i - 1], corners[i]);
 		int max_vec = vec.size();
 		if (max_vec > max) {
 			max = max_vec;
@@ -134,14 +388,17 @@ int getMaxSize(vector<Point> corners) {
  * @param binarized Binarized image by the values from the detection.
  * @param dataSegments Result decoded data segments.
  * @param detectedMarks The localization marks.
+ * @param context Context of the decoding, it holds also the perspective corners.
  * @param fun Functor for getting the perspective corners.
  * @param flags Flags used for detection and decoding.
  */
-void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegments, DetectedMarks &detectedMarks, GetPerspCorners &perspCornersFunct) const {
+void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegments, DetectedMarks &detectedMarks, DecodeContext &context,
+		const GetPerspCorners &perspCornersFunct) const {
 	dataSegments.clear();
 	dataSegments.flags = 0;
+	context.corners.clear();
 
-	vector<Point> corners;
+	vector<Point2f> corners;
 	DetectedMarks _detectedMarks = detectedMarks;
 
 	//>>> 1) GETTING THE FOUR CORNERS OF THE QR CODE FROM THE IMAGE
@@ -151,6 +408,7 @@ void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegm
 		DEBUG_PRINT(DEBUG_TAG, "FAILED TO GET FOUR CORNERS OF THE QR CODE!");
 		return;
 	}
+	Mat(corners).convertTo(context.corners, CV_32S);
 
 #ifdef TARGET_DEBUG
 	Image img;
@@ -170,11 +428,13 @@ void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegm
 	//>>> 2) PERSPECTIVE TRANSFORMATION OF THE QR CODE
 
 	int warpPerspectiveSize = getMaxSize(corners); //(binarized.cols > binarized.rows)? binarized.rows : binarized.cols;
-	warpedImage = warpPerspective(image, corners, false, Size(warpPerspectiveSize, warpPerspectiveSize));
+	Mat warpedImage = warpPerspective(image, corners, false, Size(warpPerspectiveSize, warpPerspectiveSize));
 	/*Mat perspWarped;
 	cv::GaussianBlur(image2, perspWarped, cv::Size(0, 0), 3);
 	cv::addWeighted(image2, 1.5, perspWarped, -0.5, 0, perspWarped);*/
-	warpedImage = QrDetector::binarize(warpedImage, QrDetector::FLAG_ADAPT_THRESH | QrDetector::FLAG_DISTANCE_NEAR);
+	warpedImage = QrDetector::binarize(warpedImage, QrDetector::FLAG_ADAPT_THRESH | QrDetector::FLAG_DISTANCE_NEAR |
+			(detectedMarks[2].flags & QrDetector::FLAG_INVERTED_MARK));
+	context.warpedImage = warpedImage;
 	Mat transformation = getPerspectiveTransform(corners, Size(warpPerspectiveSize, warpPerspectiveSize));
 	_detectedMarks.perspectiveTransform(transformation);
 	DEBUG_WRITE_IMAGE("warped.jpg", warpedImage);
@@ -207,6 +467,17 @@ void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegm
 
 	QrFormatInformation formatInformation = QrFormatInformation::fromBitMatrix(qrBitMatrix, versionInformation);
 
+	// Marks of the mirrored code are sorted clockwise as well, so it is sampled transposed.
+	// Its format information fails the BCH check, but it passes in the transposed bit matrix.
+	if (formatInformation == QrFormatInformation::INVALID_FORMAT) {
+		qrBitMatrix.transpose();
+		formatInformation = QrFormatInformation::fromBitMatrix(qrBitMatrix, versionInformation);
+		if (formatInformation != QrFormatInformation::INVALID_FORMAT) {
+			DEBUG_PRINT(DEBUG_TAG, "MIRRORED CODE!");
+			dataSegments.flags |= DataSegments::DATA_SEGMENTS_MIRRORED;
+		}
+	}
+
 	if (formatInformation == QrFormatInformation::INVALID_FORMAT) {
 		DEBUG_PRINT(DEBUG_TAG, "FAILED TO GET FORMAT INFORMATION!");
 		return;
@@ -276,34 +547,40 @@ void QrDecoder::_read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegm
  * @param image Image with the QR code.
  * @param dataSegments Result decoded data segments.
  * @param detectedMarks The localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the decoding.
+ * @param deadline Deadline of the decoding, checked before every perspective corners strategy.
  * @param flags Flags used for detection and decoding.
  */
-void QrDecoder::read_V1_40(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, int flags) const {
+void QrDecoder::read_V1_40(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+		DecodeContext &context, const Deadline &deadline, int flags) const {
 	DataSegments bestReadSegments;
+	vector<Point> bestCorners;
+	const GetPerspCorners *perspCornersStrategies[] = {
+		&perspCornersFromLineSampling, &perspCornersFromAlignmentPattern, &perspCornersFromFinderPattern
+	};
 
-	Mat binarized = QrDetector::binarize(image, detectedMarks[2].flags);
+	Mat binarized = QrDetector::binarize(thresholdCache, detectedMarks[2].flags);
 
-	_read_V1_40(image, binarized, dataSegments, detectedMarks, perspCornersFromLineSampling);
-	if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
-		return;
+	// Corners are refined once on the gray image, all strategies share them
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		PerspCornersHelper::refineCorners(image, detectedMarks[i]);
 	}
-	bestReadSegments = dataSegments;
 
-	_read_V1_40(image, binarized, dataSegments, detectedMarks, perspCornersFromAlignmentPattern);
-	if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
-		return;
-	} else if (dataSegments.size() > 0) {
-		bestReadSegments = dataSegments;
-	}
+	for (unsigned int i = 0; i < sizeof(perspCornersStrategies) / sizeof(GetPerspCorners *); i++) {
+		if (deadline.isExpired()) break;
 
-	_read_V1_40(image, binarized, dataSegments, detectedMarks, perspCornersFromFinderPattern);
-	if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
-		return;
-	} else if (dataSegments.size() > 0) {
-		bestReadSegments = dataSegments;
+		_read_V1_40(image, binarized, dataSegments, detectedMarks, context, *perspCornersStrategies[i]);
+		if ((!(dataSegments.flags & DataSegments::DATA_SEGMENTS_CORRUPTED)) && (dataSegments.size() > 0)) {
+			return;
+		} else if ((i == 0) || (dataSegments.size() > 0)) {
+			bestReadSegments = dataSegments;
+			bestCorners = context.corners;
+		}
 	}
 
 	dataSegments = bestReadSegments;
+	context.corners = bestCorners;
 
 }
 
@@ -23,6 +23,8 @@
 #include <opencv2/core/core.hpp>
 
 #include "../Decoder.h"
+#include "../DecodeContext.h"
+#include "../DecodedSymbol.h"
 #include "QrDetector.h"
 #include "perspcorners/GetPerspCorners.h"
 
@@ -31,6 +33,7 @@ using namespace cv;
 
 /**
  * Class of the singleton used for decoding of the QR code in the image.
+ * Decoder is immutable, mutable state of the decoding is kept in DecodeContext.
  */
 class QrDecoder: public Decoder {
 public:
@@ -43,14 +46,106 @@ public:
 	 * @param flags Flags used for detection and decoding.
 	 */
 	void decode(Image &image, DataSegments &dataSegments, int flags = QrDetector::FLAG_ADAPT_THRESH |
-			QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL) const;
+			QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL |
+			QrDetector::FLAG_SCANLINE_FINDER) const;
 
 	/**
-	 * Returns last processed image during reading.
+	 * Decodes QR code on the image until the deadline and returns decoded data segments.
+	 * Deadline is checked before every detection stage and perspective corners strategy,
+	 * the best result so far is returned and DATA_SEGMENTS_DEADLINE_EXCEEDED flag is set
+	 * if some of them has been skipped.
 	 *
-	 * @return Last processed image during reading.
+	 * @param image Image with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param deadline Deadline of the decoding.
+	 * @param flags Flags used for detection and decoding.
+	 */
+	void decode(Image &image, DataSegments &dataSegments, const Deadline &deadline, int flags = QrDetector::FLAG_ADAPT_THRESH |
+			QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL |
+			QrDetector::FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Decodes QR code on the image until the deadline and returns decoded data segments.
+	 * All mutable state of the decoding is kept in the context, so more threads
+	 * can decode at once, each of them with its own context.
+	 *
+	 * @param image Image with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param context Context of the decoding, it holds also the last processed image.
+	 * @param deadline Deadline of the decoding.
+	 * @param flags Flags used for detection and decoding.
 	 */
-	Image lastProcessedImage() const;
+	void decode(Image &image, DataSegments &dataSegments, DecodeContext &context, const Deadline &deadline,
+			int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS |
+			QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Decodes QR code from the already detected marks and returns decoded data segments.
+	 * Marks of the same parent contour are preferred, otherwise the best ranked triples
+	 * of the marks are decoded in the order of their rank.
+	 *
+	 * @param image Image with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param detectedMarks The localization marks, they are reduced to the marks used for decoding.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the decoding, it holds also the last processed image.
+	 * @param deadline Deadline of the decoding.
+	 * @param flags Flags used for detection and decoding.
+	 */
+	void decodeMarks(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+			DecodeContext &context, const Deadline &deadline, int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::REPAIR_FLAGS |
+			QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Decodes QR code only inside the regions of the image (with the margin) until the deadline
+	 * and returns decoded data segments. Detection and sampling are done only in the regions,
+	 * regions are tried in the order until the QR code is decoded without the corruption.
+	 *
+	 * @param image Image with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param regions Regions of the image where the QR code can be.
+	 * @param context Context of the decoding, it holds also the last processed image,
+	 * its corners are in the coordinates of the image.
+	 * @param deadline Deadline of the decoding, checked also before every region.
+	 * @param flags Flags used for detection and decoding.
+	 *
+	 * @see QrDetector::getSearchRegion
+	 */
+	void decode(Image &image, DataSegments &dataSegments, const vector<Rect> &regions, DecodeContext &context, const Deadline &deadline,
+			int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS |
+			QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Decodes all QR codes on the image and returns decoded symbols with their locations.
+	 * Marks are grouped into the consistent triples and every group is decoded.
+	 *
+	 * @param image Image with the QR codes.
+	 * @param symbols Result decoded symbols.
+	 * @param flags Flags used for detection and decoding.
+	 *
+	 * @see QrMarkGrouper
+	 */
+	void decode(Image &image, DecodedSymbols &symbols, int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS |
+			QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER |
+			QrDetector::FLAG_PARALLEL_DECODING) const;
+
+	/**
+	 * Decodes all QR codes on the image until the deadline and returns decoded symbols
+	 * with their locations. Marks are grouped into the consistent triples and every group
+	 * is decoded, concurrently if FLAG_PARALLEL_DECODING is set.
+	 *
+	 * @param image Image with the QR codes.
+	 * @param symbols Result decoded symbols.
+	 * @param context Context of the decoding, it holds the context of the detection.
+	 * @param deadline Deadline of the decoding, checked also before every group.
+	 * @param flags Flags used for detection and decoding.
+	 *
+	 * @see QrMarkGrouper
+	 */
+	void decode(Image &image, DecodedSymbols &symbols, DecodeContext &context, const Deadline &deadline,
+			int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS |
+			QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | QrDetector::FLAG_SCANLINE_FINDER |
+			QrDetector::FLAG_PARALLEL_DECODING) const;
 
 	/**
 	 * Returns instance of the QR decoder.
@@ -59,6 +154,9 @@ public:
 	 */
 	static const QrDecoder *getInstance();
 protected:
+	class SymbolsTask;
+	friend class SymbolsTask;
+
 	/**
 	 * Instance of the QR decoder.
 	 */
@@ -70,9 +168,10 @@ protected:
 	static const Size CODEWORD_SAMPLE_SIZE;
 
 	/**
-	 * Last processed wrapped image.
+	 * Maximal number of the best ranked triples of the marks which are decoded
+	 * when the marks do not have the common parent.
 	 */
-	mutable Mat warpedImage;
+	static const int TRIPLE_DECODE_ATTEMPTS = 3;
 
 	QrDecoder() {}
 	virtual ~QrDecoder() {}
@@ -84,10 +183,12 @@ protected:
 	 * @param binarized Binarized image by the values from the detection.
 	 * @param dataSegments Result decoded data segments.
 	 * @param detectedMarks The localization marks.
+	 * @param context Context of the decoding, it holds also the perspective corners.
 	 * @param fun Functor for getting the perspective corners.
 	 * @param flags Flags used for detection and decoding.
 	 */
-	void _read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegments, DetectedMarks &detectedMarks, GetPerspCorners &perspCornersFunct) const;
+	void _read_V1_40(Image &image, Mat &binarized, DataSegments &dataSegments, DetectedMarks &detectedMarks, DecodeContext &context,
+			const GetPerspCorners &perspCornersFunct) const;
 
 	/**
 	 * Decodes QR code of the versions 1-40 and returns decoded data segments.
@@ -95,9 +196,30 @@ protected:
 	 * @param image Image with the QR code.
 	 * @param dataSegments Result decoded data segments.
 	 * @param detectedMarks The localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the decoding.
+	 * @param deadline Deadline of the decoding, checked before every perspective corners strategy.
 	 * @param flags Flags used for detection and decoding.
 	 */
-	void read_V1_40(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, int flags = 0) const;
+	void read_V1_40(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+			DecodeContext &context, const Deadline &deadline, int flags = 0) const;
+
+	/**
+	 * Decodes the best ranked triples of the marks in the order of their rank until
+	 * the QR code is decoded without the corruption.
+	 *
+	 * @param image Image with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param detectedMarks The localization marks, they are reduced to the triple used for decoding.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the decoding.
+	 * @param deadline Deadline of the decoding, checked before every triple.
+	 * @return False if there is no consistent triple of the marks.
+	 *
+	 * @see QrMarkGrouper::rankTriples
+	 */
+	bool readRankedTriples(Image &image, DataSegments &dataSegments, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache,
+			DecodeContext &context, const Deadline &deadline) const;
 };
 
 } /* namespace barcodes */
@@ -0,0 +1,286 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrDetectionScheduler.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of QrDetectionScheduler class which orders
+//             the detection attempts by the statistics of the successful decodes.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrDetectionScheduler.cpp
+ *
+ * @brief Defines members of QrDetectionScheduler class which orders
+ *        the detection attempts by the statistics of the successful decodes.
+ * @author agent agent(at)local
+ */
+
+#include <set>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+
+#include "QrDetectionScheduler.h"
+#include "QrDetector.h"
+
+namespace barcodes {
+
+/**
+ * Instance of the scheduler.
+ */
+QrDetectionScheduler QrDetectionScheduler::SCHEDULER_INSTANCE;
+
+/**
+ * Repair passes in the default order.
+ */
+static const int REPAIR_PASSES[] = {
+	0, QrDetector::FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR, QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR
+};
+
+/**
+ * Distances in the default order.
+ */
+static const int DISTANCES[] = {
+	QrDetector::FLAG_DISTANCE_NEAR, QrDetector::FLAG_DISTANCE_MEDIUM,
+	QrDetector::FLAG_DISTANCE_FAR, QrDetector::FLAG_DISTANCE_FAR_FAR
+};
+
+/**
+ * Orders the scored attempts from the best score.
+ */
+static bool compareScores(const pair<double, int> &first, const pair<double, int> &second) {
+	return first.first > second.first;
+}
+
+QrDetectionScheduler::QrDetectionScheduler() : unsavedSuccesses(0) {
+	pthread_mutex_init(&mutex, NULL);
+	pthread_mutex_init(&profileMutex, NULL);
+}
+
+QrDetectionScheduler::~QrDetectionScheduler() {
+	pthread_mutex_destroy(&profileMutex);
+	pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * Returns the enabled attempts ordered by the score, the best attempt first.
+ *
+ * @param flags Detection flags, repair and distance flags select the attempts.
+ * @param attempts Output repair and distance flags of the attempts.
+ */
+void QrDetectionScheduler::getAttempts(int flags, vector<int> &attempts) {
+	vector<pair<double, int> > scored;
+
+	pthread_mutex_lock(&mutex);
+	for (unsigned int i = 0; i < sizeof(REPAIR_PASSES) / sizeof(int); i++) {
+		if ((REPAIR_PASSES[i] != 0) && !(flags & REPAIR_PASSES[i])) continue;
+
+		// Without any distance flag the default block size is used
+		if (!(flags & QrDetector::DISTANCE_FLAGS)) {
+			scored.push_back(pair<double, int>(getScore(REPAIR_PASSES[i]), REPAIR_PASSES[i]));
+			continue;
+		}
+
+		for (unsigned int j = 0; j < sizeof(DISTANCES) / sizeof(int); j++) {
+			if (!(flags & DISTANCES[j])) continue;
+			int attemptFlags = REPAIR_PASSES[i] | DISTANCES[j];
+			scored.push_back(pair<double, int>(getScore(attemptFlags), attemptFlags));
+		}
+	}
+	pthread_mutex_unlock(&mutex);
+
+	// Attempts with the same score stay in the default order
+	stable_sort(scored.begin(), scored.end(), compareScores);
+
+	attempts.clear();
+	for (unsigned int i = 0; i < scored.size(); i++) {
+		attempts.push_back(scored[i].second);
+	}
+}
+
+/**
+ * Records one run of the attempt.
+ *
+ * @param attemptFlags Repair and distance flags of the attempt.
+ * @param cost Time spent by the attempt [ms].
+ */
+void QrDetectionScheduler::recordAttempt(int attemptFlags, double cost) {
+	pthread_mutex_lock(&mutex);
+	Statistics &attemptStatistics = statistics[attemptFlags];
+	if (attemptStatistics.tries >= STATISTICS_MAX_TRIES) {
+		attemptStatistics.tries /= 2;
+		attemptStatistics.successes /= 2;
+		attemptStatistics.cost /= 2;
+	}
+	attemptStatistics.tries++;
+	attemptStatistics.cost += cost;
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Records the successful decode. Every attempt which has contributed
+ * by the marks (attempts of the marks) is credited once. Profile file is written
+ * outside of the lock of the statistics.
+ *
+ * @param detectedMarks Marks used for the successful decode.
+ */
+void QrDetectionScheduler::recordSuccess(const DetectedMarks &detectedMarks) {
+	set<int> attempts;
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		if (detectedMarks[i].attempt >= 0) attempts.insert(detectedMarks[i].attempt);
+	}
+
+	pthread_mutex_lock(&mutex);
+	for (set<int>::iterator iter = attempts.begin(); iter != attempts.end(); ++iter) {
+		map<int, Statistics>::iterator attemptStatistics = statistics.find(*iter);
+		if (attemptStatistics != statistics.end()) {
+			attemptStatistics->second.successes++;
+		}
+	}
+
+	// Statistics are copied, so the other threads do not wait for the file
+	string savedPath;
+	map<int, Statistics> savedStatistics;
+	if ((!profilePath.empty()) && (++unsavedSuccesses >= PROFILE_SAVE_PERIOD)) {
+		savedPath = profilePath;
+		savedStatistics = statistics;
+		unsavedSuccesses = 0;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	if (!savedPath.empty()) {
+		writeProfile(savedPath, savedStatistics);
+	}
+}
+
+/**
+ * Loads the statistics from the profile file, current statistics are replaced.
+ *
+ * @param path Path of the profile file.
+ * @return True if the profile has been loaded, otherwise false.
+ */
+bool QrDetectionScheduler::loadProfile(const string &path) {
+	ifstream profile(path.c_str());
+	if (!profile.is_open()) return false;
+
+	map<int, Statistics> loaded;
+	string line;
+	while (getline(profile, line)) {
+		if (line.empty() || (line[0] == '#')) continue;
+
+		istringstream lineStream(line);
+		int attemptFlags;
+		Statistics attemptStatistics;
+		if (!(lineStream >> attemptFlags >> attemptStatistics.tries >> attemptStatistics.successes >> attemptStatistics.cost)) {
+			return false;
+		}
+		loaded[attemptFlags] = attemptStatistics;
+	}
+
+	pthread_mutex_lock(&mutex);
+	statistics = loaded;
+	pthread_mutex_unlock(&mutex);
+
+	return true;
+}
+
+/**
+ * Saves the statistics to the profile file.
+ *
+ * @param path Path of the profile file.
+ * @return True if the profile has been saved, otherwise false.
+ */
+bool QrDetectionScheduler::saveProfile(const string &path) {
+	pthread_mutex_lock(&mutex);
+	map<int, Statistics> savedStatistics = statistics;
+	pthread_mutex_unlock(&mutex);
+
+	return writeProfile(path, savedStatistics);
+}
+
+/**
+ * Sets the profile file which is loaded now and saved after every
+ * PROFILE_SAVE_PERIOD successes. Empty path disables the saving.
+ *
+ * @param path Path of the profile file.
+ * @return True if the profile has been loaded, otherwise false.
+ */
+bool QrDetectionScheduler::setProfile(const string &path) {
+	bool loaded = (!path.empty()) && loadProfile(path);
+
+	pthread_mutex_lock(&mutex);
+	profilePath = path;
+	unsavedSuccesses = 0;
+	pthread_mutex_unlock(&mutex);
+
+	return loaded;
+}
+
+/**
+ * Forgets all statistics.
+ */
+void QrDetectionScheduler::reset() {
+	pthread_mutex_lock(&mutex);
+	statistics.clear();
+	unsavedSuccesses = 0;
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Returns instance of the scheduler.
+ *
+ * @return Instance of the scheduler.
+ */
+QrDetectionScheduler *QrDetectionScheduler::getInstance() {
+	return &SCHEDULER_INSTANCE;
+}
+
+/**
+ * Returns the score of the attempt, success probability per unit of cost. Mutex has to be locked.
+ *
+ * @param attemptFlags Repair and distance flags of the attempt.
+ * @return Score of the attempt.
+ */
+double QrDetectionScheduler::getScore(int attemptFlags) const {
+	Statistics attemptStatistics;
+	map<int, Statistics>::const_iterator iter = statistics.find(attemptFlags);
+	if (iter != statistics.end()) {
+		attemptStatistics = iter->second;
+	}
+
+	// Laplace estimate, attempts without any run have probability 0.5 and the prior cost
+	double probability = (attemptStatistics.successes + 1) / (attemptStatistics.tries + 2);
+	double cost = (attemptStatistics.cost + PRIOR_ATTEMPT_COST) / (attemptStatistics.tries + 1);
+
+	return probability / cost;
+}
+
+/**
+ * Saves the statistics to the profile file. Writes of the file are serialized
+ * by the profile mutex, mutex of the statistics must not be locked.
+ *
+ * @param path Path of the profile file.
+ * @param savedStatistics Copy of the statistics.
+ * @return True if the profile has been saved, otherwise false.
+ */
+bool QrDetectionScheduler::writeProfile(const string &path, const map<int, Statistics> &savedStatistics) {
+	pthread_mutex_lock(&profileMutex);
+	ofstream profile(path.c_str());
+	bool saved = profile.is_open();
+
+	if (saved) {
+		profile << "# attempt_flags tries successes cost_ms" << endl;
+		for (map<int, Statistics>::const_iterator iter = savedStatistics.begin(); iter != savedStatistics.end(); ++iter) {
+			profile << iter->first << " " << iter->second.tries << " " << iter->second.successes << " " << iter->second.cost << endl;
+		}
+		profile.close();
+		saved = !profile.fail();
+	}
+	pthread_mutex_unlock(&profileMutex);
+
+	return saved;
+}
+
+} /* namespace barcodes */
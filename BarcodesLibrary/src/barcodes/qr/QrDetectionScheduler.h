@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrDetectionScheduler.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines QrDetectionScheduler class which orders the detection
+//             attempts by the statistics of the successful decodes.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrDetectionScheduler.h
+ *
+ * @brief Defines QrDetectionScheduler class which orders the detection
+ *        attempts by the statistics of the successful decodes.
+ * @author agent agent(at)local
+ */
+
+#ifndef QRDETECTIONSCHEDULER_H_
+#define QRDETECTIONSCHEDULER_H_
+
+#include <map>
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+#include "../DetectedMarks.h"
+
+namespace barcodes {
+using namespace std;
+
+/**
+ * Singleton which orders the detection attempts (combinations of the repair
+ * and distance flags) by the estimated success probability per unit of cost.
+ * The probability is estimated from the decodes which have succeeded with
+ * the marks of the attempt, the cost is the average time of the attempt.
+ * Attempts without statistics keep the default order (no repair, fill repair,
+ * flood fill repair and the distances from near to far). Statistics can be
+ * persisted in the profile file.
+ */
+class QrDetectionScheduler {
+public:
+
+	/**
+	 * Returns the enabled attempts ordered by the score, the best attempt first.
+	 *
+	 * @param flags Detection flags, repair and distance flags select the attempts.
+	 * @param attempts Output repair and distance flags of the attempts.
+	 */
+	void getAttempts(int flags, vector<int> &attempts);
+
+	/**
+	 * Records one run of the attempt.
+	 *
+	 * @param attemptFlags Repair and distance flags of the attempt.
+	 * @param cost Time spent by the attempt [ms].
+	 */
+	void recordAttempt(int attemptFlags, double cost);
+
+	/**
+	 * Records the successful decode. Every attempt which has contributed
+	 * by the marks (attempts of the marks) is credited once. Profile file is written
+	 * outside of the lock of the statistics.
+	 *
+	 * @param detectedMarks Marks used for the successful decode.
+	 */
+	void recordSuccess(const DetectedMarks &detectedMarks);
+
+	/**
+	 * Loads the statistics from the profile file, current statistics are replaced.
+	 *
+	 * @param path Path of the profile file.
+	 * @return True if the profile has been loaded, otherwise false.
+	 */
+	bool loadProfile(const string &path);
+
+	/**
+	 * Saves the statistics to the profile file.
+	 *
+	 * @param path Path of the profile file.
+	 * @return True if the profile has been saved, otherwise false.
+	 */
+	bool saveProfile(const string &path);
+
+	/**
+	 * Sets the profile file which is loaded now and saved after every
+	 * PROFILE_SAVE_PERIOD successes. Empty path disables the saving.
+	 *
+	 * @param path Path of the profile file.
+	 * @return True if the profile has been loaded, otherwise false.
+	 */
+	bool setProfile(const string &path);
+
+	/**
+	 * Forgets all statistics.
+	 */
+	void reset();
+
+	/**
+	 * Returns instance of the scheduler.
+	 *
+	 * @return Instance of the scheduler.
+	 */
+	static QrDetectionScheduler *getInstance();
+protected:
+
+	/**
+	 * Statistics of one attempt.
+	 */
+	struct Statistics {
+
+		/**
+		 * Number of the runs of the attempt.
+		 */
+		double tries;
+
+		/**
+		 * Number of the successful decodes with the marks of the attempt.
+		 */
+		double successes;
+
+		/**
+		 * Total time of the runs [ms].
+		 */
+		double cost;
+
+		Statistics() : tries(0), successes(0), cost(0) {}
+	};
+
+	/**
+	 * Instance of the scheduler.
+	 */
+	static QrDetectionScheduler SCHEDULER_INSTANCE;
+
+	/**
+	 * The cost of the attempt which has not been run yet [ms]. It also smooths
+	 * the average cost of the attempts with a few runs.
+	 */
+	static const double PRIOR_ATTEMPT_COST                      =    10;
+
+	/**
+	 * The number of the runs after which are the statistics of the attempt halved,
+	 * so the older results lose the weight when the scene changes.
+	 */
+	static const double STATISTICS_MAX_TRIES                    =    1000;
+
+	/**
+	 * The number of the successes after which is the profile saved.
+	 */
+	static const int PROFILE_SAVE_PERIOD                        =    16;
+
+	/**
+	 * Statistics of the attempts by their flags.
+	 */
+	map<int, Statistics> statistics;
+
+	/**
+	 * Path of the profile file, empty if the profile is not saved.
+	 */
+	string profilePath;
+
+	/**
+	 * Number of the successes which have not been saved yet.
+	 */
+	int unsavedSuccesses;
+
+	/**
+	 * Mutex guarding the statistics.
+	 */
+	pthread_mutex_t mutex;
+
+	/**
+	 * Mutex serializing the writes of the profile file.
+	 */
+	pthread_mutex_t profileMutex;
+
+	QrDetectionScheduler();
+	virtual ~QrDetectionScheduler();
+
+	/**
+	 * Returns the score of the attempt, success probability per unit of cost. Mutex has to be locked.
+	 *
+	 * @param attemptFlags Repair and distance flags of the attempt.
+	 * @return Score of the attempt.
+	 */
+	double getScore(int attemptFlags) const;
+
+	/**
+	 * Saves the statistics to the profile file. Writes of the file are serialized
+	 * by the profile mutex, mutex of the statistics must not be locked.
+	 *
+	 * @param path Path of the profile file.
+	 * @param savedStatistics Copy of the statistics.
+	 * @return True if the profile has been saved, otherwise false.
+	 */
+	bool writeProfile(const string &path, const map<int, Statistics> &savedStatistics);
+};
+
+} /* namespace barcodes */
+#endif /* QRDETECTIONSCHEDULER_H_ */
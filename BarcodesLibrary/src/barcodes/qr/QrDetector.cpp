@@ -22,8 +22,12 @@
 #include "../../debug.h"
 #include "../../common/Polygon2D.h"
 #include "../../common/miscellaneous.h"
+#include "../../common/MeanThreshold.h"
+#include "../../common/ThreadPool.h"
 #include "QrDetector.h"
 #include "QrBuildHelper.h"
+#include "QrScanlineFinder.h"
+#include "QrDetectionScheduler.h"
 
 #define DEBUG_TAG "QrDetector.cpp"
 
@@ -34,6 +38,130 @@ namespace barcodes {
  */
 const QrDetector QrDetector::DETECTOR_INSTANCE = QrDetector();
 
+/**
+ * Distances in the order of the detection priority.
+ */
+static const int DISTANCE_LEVELS[] = {
+	QrDetector::FLAG_DISTANCE_NEAR, QrDetector::FLAG_DISTANCE_MEDIUM,
+	QrDetector::FLAG_DISTANCE_FAR, QrDetector::FLAG_DISTANCE_FAR_FAR
+};
+
+/**
+ * Number of the distances.
+ */
+static const int DISTANCE_LEVELS_COUNT = sizeof(DISTANCE_LEVELS) / sizeof(int);
+
+/**
+ * Parallel task which detects the marks of one distance per index. Marks are merged
+ * in the order of the distances as soon as all nearer distances are done, after the
+ * successful merge the farther distances are cancelled. Distances are cancelled
+ * also when the deadline expires.
+ */
+class QrDetector::DistancesTask : public ParallelTask {
+public:
+	DistancesTask(const QrDetector &detector, ThresholdCache &thresholdCache, DetectContext &context, const Deadline &deadline,
+			const DetectedMarks &detectedMarks, int distanceFlags, int flags) : detector(detector),
+			thresholdCache(thresholdCache), context(context), deadline(deadline), mergedMarks(detectedMarks), flags(flags),
+			mergedLevels(0), lastLevel(INT_MAX) {
+		pthread_mutex_init(&mutex, NULL);
+		for (int i = 0; i < DISTANCE_LEVELS_COUNT; i++) {
+			if (distanceFlags & DISTANCE_LEVELS[i]) levels.push_back(DISTANCE_LEVELS[i]);
+		}
+		marks.resize(levels.size());
+		done.resize(levels.size(), 0);
+	}
+
+	virtual ~DistancesTask() {
+		pthread_mutex_destroy(&mutex);
+	}
+
+	int getLevelsCount() const {
+		return levels.size();
+	}
+
+	void getMarks(DetectedMarks &detectedMarks) const {
+		detectedMarks = mergedMarks;
+	}
+
+	void run(int from, int to) {
+		for (int level = from; level < to; level++) {
+			if (isCancelled(level)) continue;
+			Mat binarized = QrDetector::binarize(thresholdCache, flags | levels[level]);
+
+			if (isCancelled(level)) continue;
+			detector._detect(binarized, marks[level], context, flags);
+
+			finish(level);
+		}
+	}
+protected:
+	const QrDetector &detector;
+	ThresholdCache &thresholdCache;
+	DetectContext &context;
+	const Deadline &deadline;
+	DetectedMarks mergedMarks;
+	int flags;
+	vector<int> levels;
+	vector<DetectedMarks> marks;
+	vector<uchar> done;
+	unsigned int mergedLevels;
+	int lastLevel;
+	pthread_mutex_t mutex;
+
+	bool isCancelled(int level) {
+		if (deadline.isExpired()) return true;
+
+		pthread_mutex_lock(&mutex);
+		bool cancelled = level > lastLevel;
+		pthread_mutex_unlock(&mutex);
+		return cancelled;
+	}
+
+	void finish(int level) {
+		pthread_mutex_lock(&mutex);
+		done[level] = 1;
+		while ((lastLevel == INT_MAX) && (mergedLevels < levels.size()) && done[mergedLevels]) {
+			if (QrDetector::mergeDistanceMarks(mergedMarks, marks[mergedLevels], levels[mergedLevels])) {
+				lastLevel = mergedLevels;
+			}
+			mergedLevels++;
+		}
+		pthread_mutex_unlock(&mutex);
+	}
+};
+
+/**
+ * Parallel task which verifies the finder pattern candidates.
+ */
+class QrDetector::CandidatesTask : public ParallelTask {
+public:
+	CandidatesTask(const QrDetector &detector, Mat &image, vector<vector<Point> > &contours, vector<Vec4i> &hierarchy,
+			int flags, double matchTolerance, int markMinSize, vector<DetectedMark> &marks, vector<uchar> &verified) :
+		detector(detector), image(image), contours(contours), hierarchy(hierarchy), flags(flags),
+		matchTolerance(matchTolerance), markMinSize(markMinSize), marks(marks), verified(verified) {}
+
+	void run(int from, int to) {
+		vector<uint64_t> packedCropped;
+		for (int i = from; i < to; i++) {
+			verified[i] = detector.verifyCandidate(image, contours, hierarchy, i, flags, matchTolerance, markMinSize, marks[i], packedCropped);
+		}
+	}
+protected:
+	const QrDetector &detector;
+	Mat &image;
+	vector<vector<Point> > &contours;
+	vector<Vec4i> &hierarchy;
+	int flags;
+	double matchTolerance;
+	int markMinSize;
+	vector<DetectedMark> &marks;
+	vector<uchar> &verified;
+};
+
+QrDetector::QrDetector() {
+	packBinarized(QrBuildHelper::buildQrMark(QR_MARK_TEMPLATE_SIZE), packedQrMark);
+}
+
 /**
  * Detects QR code and returns localization marks.
  *
@@ -42,29 +170,200 @@ const QrDetector QrDetector::DETECTOR_INSTANCE = QrDetector();
  * @param flags Detection flags.
  */
 void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, int flags) const {
+	ThresholdCache thresholdCache(image, flags & FLAG_PARALLEL_BINARIZATION);
+	detect(image, detectedMarks, thresholdCache, flags);
+}
+
+/**
+ * Detects QR code and returns localization marks.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param flags Detection flags.
+ */
+void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, int flags) const {
+	detect(image, detectedMarks, thresholdCache, Deadline(), flags);
+}
+
+/**
+ * Detects QR code and returns localization marks found until the deadline.
+ * Deadline is checked before every repair pass and distance, it is exceeded
+ * if some of them has been skipped.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param deadline Deadline of the detection.
+ * @param flags Detection flags.
+ */
+void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, const Deadline &deadline, int flags) const {
+	DetectContext context;
+	detect(image, detectedMarks, thresholdCache, context, deadline, flags);
+}
+
+/**
+ * Detects QR code and returns localization marks found until the deadline.
+ * All mutable state of the detection is kept in the context, so more threads
+ * can detect at once, each of them with its own context.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection, it is reset at the start.
+ * @param deadline Deadline of the detection.
+ * @param flags Detection flags.
+ */
+void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		const Deadline &deadline, int flags) const {
+	context.reset();
+	detectMarks(image, detectedMarks, thresholdCache, context, deadline, flags);
+}
+
+/**
+ * Detects QR code only inside the regions of the image (with the margin)
+ * and returns localization marks in the coordinates of the whole image.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param regions Regions of the image where the QR code can be.
+ * @param flags Detection flags.
+ *
+ * @see getSearchRegion
+ */
+void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, int flags) const {
+	DetectContext context;
+	detect(image, detectedMarks, regions, context, Deadline(), flags);
+}
+
+/**
+ * Detects QR code only inside the regions of the image (with the margin) until
+ * the deadline and returns localization marks in the coordinates of the whole image.
+ * Binarization and contours are calculated only for the regions.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param regions Regions of the image where the QR code can be.
+ * @param context Context of the detection, it is reset at the start.
+ * @param deadline Deadline of the detection, checked also before every region.
+ * @param flags Detection flags.
+ *
+ * @see getSearchRegion
+ */
+void QrDetector::detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, DetectContext &context,
+		const Deadline &deadline, int flags) const {
+	DetectedMarks regionMarks;
+	detectedMarks.clear();
+	context.reset();
+
+	for (unsigned int i = 0; i < regions.size(); i++) {
+		Rect searchRegion = getSearchRegion(regions[i], Size(image.cols, image.rows));
+		if (searchRegion.area() == 0) continue;
+		if (deadline.isExpired()) break;
+
+		// Region shares the data with the image, every region has its own thresholds
+		Image regionImage(((Mat &)image)(searchRegion), image.getColorFormat());
+		ThresholdCache regionCache(regionImage, flags & FLAG_PARALLEL_BINARIZATION);
+		detectMarks(regionImage, regionMarks, regionCache, context, deadline, flags);
+
+		for (unsigned int j = 0; j < regionMarks.size(); j++) {
+			Polygon2D::offset(regionMarks[j].points, searchRegion.tl());
+		}
+
+		// Overlapping regions find the same marks
+		detectedMarks.insert(detectedMarks.end(), regionMarks.begin(), regionMarks.end());
+		detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
+	}
+}
+
+/**
+ * Returns the region extended by the margin and clipped by the image. The margin
+ * covers the finder patterns which reach out of the region.
+ *
+ * @param region Region of the image where the QR code can be.
+ * @param imageSize Size of the image.
+ * @return Searched region, empty if the region is outside the image.
+ *
+ * @see REGION_MARGIN_RATIO
+ */
+Rect QrDetector::getSearchRegion(const Rect &region, Size imageSize) {
+	int margin = max(region.width, region.height) * REGION_MARGIN_RATIO;
+	Rect searchRegion(region.x - margin, region.y - margin, region.width + 2 * margin, region.height + 2 * margin);
+	searchRegion &= Rect(0, 0, imageSize.width, imageSize.height);
+
+	return searchRegion;
+}
+
+/**
+ * Detects QR code in one pass with the adaptive threshold of the specified block size,
+ * distance and repair flags are ignored. It serves for the detection when the size
+ * of the modules is already known (e.g. tracking of the QR code).
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection, it is reset at the start.
+ * @param blockSize Size of the block for adaptive threshold (odd number).
+ * @param flags Match tolerance/Scanline finder flags.
+ */
+void QrDetector::detectWithBlockSize(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		int blockSize, int flags) const {
+	detectedMarks.clear();
+	context.reset();
+	if (image.data == NULL) return;
+
+	Mat binarized = thresholdCache.adaptiveThreshold(blockSize, BINARIZE_MEAN_C);
+	_detect(binarized, detectedMarks, context, flags & ~(REPAIR_FLAGS | DISTANCE_FLAGS));
+}
+
+/**
+ * Detects QR code and returns localization marks found until the deadline.
+ * Context is not reset, so the marks of more detections can be merged.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection.
+ * @param deadline Deadline of the detection.
+ * @param flags Detection flags.
+ */
+void QrDetector::detectMarks(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		const Deadline &deadline, int flags) const {
 	detectedMarks.clear();
 	DEBUG_PRINT(DEBUG_TAG, ">>>>>>>>>>> DETECT START <<<<<<<<<<<<<");
 	if (image.data != NULL) {
 		DetectedMarks marks;
 		int repairFlags = flags & REPAIR_FLAGS;
 
+		// Images without any plausible finder pattern are not worth of the binarization
+		if ((flags & FLAG_PRESENCE_TEST) && !QrScanlineFinder::isPresent(image, getMarkMinimalSize(flags))) goto return_end;
+
+		// Coarse detection, the full resolution is used only around the found marks
+		if ((flags & FLAG_PYRAMID_DETECTION) && detectOnPyramid(image, detectedMarks, context, deadline, flags)) goto return_end;
+
+		// Repair passes and distances in the order of their success statistics
+		if (flags & FLAG_ADAPTIVE_SCHEDULING) {
+			detectBySchedule(detectedMarks, thresholdCache, context, deadline, flags);
+			goto return_end;
+		}
+
 		flags = flags & ~repairFlags;
 
 		// Detection without any repairs
-		detectByDistancePriority(image, detectedMarks, flags);
+		detectByDistancePriority(detectedMarks, thresholdCache, context, deadline, flags);
 		if (detectedMarks.size() > 2) goto return_end;
 
 		// Detection with corrupt fill repair
-		if (repairFlags & FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR) {
-			detectByDistancePriority(image, marks, flags | FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR);
+		if ((repairFlags & FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR) && !deadline.isExpired()) {
+			detectByDistancePriority(marks, thresholdCache, context, deadline, flags | FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR);
 			detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
 			detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
 			if (detectedMarks.size() > 2) goto return_end;
 		}
 
 		// Detection with flood fill repair
-		if (repairFlags & FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR) {
-			detectByDistancePriority(image, marks, flags | FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR);
+		if ((repairFlags & FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR) && !deadline.isExpired()) {
+			detectByDistancePriority(marks, thresholdCache, context, deadline, flags | FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR);
 			detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
 			detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
 			if (detectedMarks.size() > 2) goto return_end;
@@ -88,12 +387,15 @@ const QrDetector *QrDetector::getInstance() {
 /**
  * Detects QR code and returns localization marks.
  *
- * @param image Image with the QR code.
  * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection.
+ * @param deadline Deadline of the detection, checked before every distance.
  * @param flags Match tolerance/Distance flags.
  */
-void QrDetector::detectByDistancePriority(Image &image, DetectedMarks &detectedMarks, int flags) const {
-DEBUG_PRINT(DEBUG_TAG, "detectByDistancePriority(image,detectedMarks,%d)", flags);
+void QrDetector::detectByDistancePriority(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		const Deadline &deadline, int flags) const {
+DEBUG_PRINT(DEBUG_TAG, "detectByDistancePriority(detectedMarks,%d)", flags);
 
 	DetectedMarks marks;
 	Mat binarized;
@@ -101,52 +403,184 @@ DEBUG_PRINT(DEBUG_TAG, "detectByDistancePriority(image,detectedMarks,%d)", flags
 	flags = flags & ~distanceFlags;
 
 	// Default decoding
-	if (distanceFlags == 0) {
-		binarized = binarize(image, flags);
-		_detect(binarized, marks, flags);
+	if ((distanceFlags == 0) && !deadline.isExpired()) {
+		binarized = binarize(thresholdCache, flags);
+		_detect(binarized, marks, context, flags);
+	}
+
+	// Distances run concurrently, the farther ones are cancelled once the nearer ones succeed
+	if ((flags & FLAG_PARALLEL_DISTANCES) && (distanceFlags & (distanceFlags - 1))) {
+		detectDistancesInParallel(detectedMarks, thresholdCache, context, deadline, distanceFlags, flags);
+		return;
 	}
 
-	// Near distance
-	if (distanceFlags & FLAG_DISTANCE_NEAR) {
+	for (int i = 0; i < DISTANCE_LEVELS_COUNT; i++) {
+		if (!(distanceFlags & DISTANCE_LEVELS[i])) continue;
+		if (deadline.isExpired()) return;
+
 		marks.clear();
-		binarized = binarize(image, flags | FLAG_DISTANCE_NEAR);
-		_detect(binarized, marks, flags);
+		binarized = binarize(thresholdCache, flags | DISTANCE_LEVELS[i]);
+		_detect(binarized, marks, context, flags);
 
-		detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
-		if (detectedMarks.size() > 2) return;
+		if (mergeDistanceMarks(detectedMarks, marks, DISTANCE_LEVELS[i])) return;
 	}
+}
 
-	// Medium distance
-	if (distanceFlags & FLAG_DISTANCE_MEDIUM) {
-		marks.clear();
-		binarized = binarize(image, flags | FLAG_DISTANCE_MEDIUM);
-		_detect(binarized, marks, flags);
+/**
+ * Detects QR code by the attempts (repair and distance flags) in the order
+ * of the detection scheduler. Time of every attempt is recorded, marks are merged
+ * in the same way as by the detection by distance priority.
+ *
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection.
+ * @param deadline Deadline of the detection, checked before every attempt.
+ * @param flags Detection flags.
+ */
+void QrDetector::detectBySchedule(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		const Deadline &deadline, int flags) const {
+	QrDetectionScheduler *scheduler = QrDetectionScheduler::getInstance();
+	DetectedMarks marks;
+	vector<int> attempts;
+	scheduler->getAttempts(flags, attempts);
+	flags = flags & ~(REPAIR_FLAGS | DISTANCE_FLAGS);
 
-		detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
-		detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
-		if (detectedMarks.size() > 2) return;
+	for (unsigned int i = 0; i < attempts.size(); i++) {
+		if (deadline.isExpired()) return;
+
+		int64 start = getTickCount();
+		Mat binarized = binarize(thresholdCache, flags | attempts[i]);
+		_detect(binarized, marks, context, flags | (attempts[i] & REPAIR_FLAGS));
+		scheduler->recordAttempt(attempts[i], (getTickCount() - start) * 1000.0 / getTickFrequency());
+
+		// Attempt of the marks is credited when the decode succeeds, flags stay as of the sequential detection
+		for (unsigned int j = 0; j < marks.size(); j++) {
+			marks[j].attempt = attempts[i];
+		}
+
+		if (mergeDistanceMarks(detectedMarks, marks, attempts[i] & DISTANCE_FLAGS)) return;
 	}
+}
 
-	// Far distance
-	if (distanceFlags & FLAG_DISTANCE_FAR) {
-		marks.clear();
-		binarized = binarize(image, flags | FLAG_DISTANCE_FAR);
-		_detect(binarized, marks, flags);
+/**
+ * Detects the marks on the downscaled image and refines them in the full resolution.
+ *
+ * @param image Image with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param context Context of the detection.
+ * @param deadline Deadline of the detection.
+ * @param flags Detection flags.
+ * @return True if the marks have been found on the downscaled image.
+ */
+bool QrDetector::detectOnPyramid(Image &image, DetectedMarks &detectedMarks, DetectContext &context, const Deadline &deadline, int flags) const {
+	Mat level = image;
+	int scale = 1;
+	while ((scale < PYRAMID_MAX_SCALE) && (min(level.cols, level.rows) / 2 >= PYRAMID_MIN_LEVEL_SIZE)) {
+		Mat downscaled;
+		pyrDown(level, downscaled);
+		level = downscaled;
+		scale *= 2;
+	}
+	if (scale == 1) return false;
 
-		detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
-		detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
-		if (detectedMarks.size() > 2) return;
+	DetectedMarks coarseMarks;
+	Image levelImage(level, IMAGE_COLOR_GRAYSCALE);
+	ThresholdCache levelCache(level, flags & FLAG_PARALLEL_BINARIZATION);
+	detectMarks(levelImage, coarseMarks, levelCache, context, deadline, flags & ~FLAG_PYRAMID_DETECTION);
+	DEBUG_PRINT(DEBUG_TAG, "pyramid scale: %d, coarse marks: %d", scale, coarseMarks.size());
+	if (coarseMarks.size() < 3) return false;
+
+	int refineFlags = flags & (MATCH_TOLERANCE_FLAGS | FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR | FLAG_DUAL_POLARITY);
+	for (unsigned int i = 0; i < coarseMarks.size(); i++) {
+
+		// Pixel of the level is centered on the pixel (x * scale, y * scale) of the image
+		DetectedMark mark = coarseMarks[i];
+		for (unsigned int j = 0; j < mark.points.size(); j++) {
+			mark.points[j] = Point(mark.points[j].x * scale, mark.points[j].y * scale);
+		}
+
+		refineMark(image, mark, context, refineFlags);
+		detectedMarks.push_back(mark);
 	}
 
-	// Far Far distance
-	if (distanceFlags & FLAG_DISTANCE_FAR_FAR) {
-		marks.clear();
-		binarized = binarize(image, flags | FLAG_DISTANCE_FAR_FAR);
-		_detect(binarized, marks, flags);
+	return true;
+}
 
-		detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
+/**
+ * Refines the mark found on the downscaled image in the full resolution window around it.
+ * Points of the mark are kept if the mark is not found inside the window.
+ *
+ * @param image Full resolution image.
+ * @param mark Mark with the points mapped to the full resolution.
+ * @param context Context of the detection.
+ * @param flags Match tolerance/Repair flags.
+ */
+void QrDetector::refineMark(Mat &image, DetectedMark &mark, DetectContext &context, int flags) const {
+	Rect markRect = boundingRect(Mat(mark.points));
+	int margin = max(markRect.width, markRect.height);
+	Rect window(markRect.x - margin, markRect.y - margin, markRect.width + 2 * margin, markRect.height + 2 * margin);
+	window &= Rect(0, 0, image.cols, image.rows);
+	if ((window.width == 0) || (window.height == 0)) return;
+
+	// Window is about three times larger than the mark, near distance block size fits it
+	Mat windowImage = image(window);
+	Mat binarized = binarize(windowImage, FLAG_ADAPT_THRESH | FLAG_DISTANCE_NEAR);
+
+	DetectedMarks marks;
+	_detect(binarized, marks, context, flags);
+
+	// The mark closest to the coarse one, at most half of its size away
+	Point2f center = mark.getBox().center;
+	double maxDistance = (markRect.width + markRect.height) / 4.0;
+	int closest = -1;
+	for (unsigned int i = 0; i < marks.size(); i++) {
+		Point2f markCenter = marks[i].getBox().center;
+		double distance = norm(Point2f(markCenter.x + window.x - center.x, markCenter.y + window.y - center.y));
+		if (distance < maxDistance) {
+			maxDistance = distance;
+			closest = i;
+		}
+	}
+	if (closest < 0) return;
+
+	mark.points = marks[closest].points;
+	Polygon2D::offset(mark.points, Point(window.x, window.y));
+	mark.match = marks[closest].match;
+}
+
+/**
+ * Detects all enabled distances concurrently on the shared thread pool. Farther
+ * distances are cancelled once the nearer ones have found the marks, the result
+ * is the same as of the sequential detection.
+ *
+ * @param detectedMarks Recognized localization marks.
+ * @param thresholdCache Cache of the thresholds of the image.
+ * @param context Context of the detection.
+ * @param deadline Deadline of the detection, distances not started before it are skipped.
+ * @param distanceFlags Distances which should be detected.
+ * @param flags Match tolerance/Repair flags.
+ */
+void QrDetector::detectDistancesInParallel(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+		const Deadline &deadline, int distanceFlags, int flags) const {
+	DistancesTask task(*this, thresholdCache, context, deadline, detectedMarks, distanceFlags, flags);
+	ThreadPool::getInstance()->parallelFor(0, task.getLevelsCount(), 1, task);
+	task.getMarks(detectedMarks);
+}
+
+/**
+ * Merges the marks of one distance into the marks of the nearer distances.
+ *
+ * @param detectedMarks Marks of the nearer distances.
+ * @param marks Marks of the distance.
+ * @param distanceFlag Flag of the distance.
+ * @return True if enough marks have been found and the farther distances are not needed.
+ */
+bool QrDetector::mergeDistanceMarks(DetectedMarks &detectedMarks, DetectedMarks &marks, int distanceFlag) {
+	detectedMarks.insert(detectedMarks.end(), marks.begin(), marks.end());
+	if (distanceFlag != FLAG_DISTANCE_NEAR) {
 		detectedMarks.filter(QR_MARK_CENTER_POINTS_MINIMUM_DISTANCE);
 	}
+	return detectedMarks.size() > 2;
 }
 
 /**
@@ -154,143 +588,431 @@ DEBUG_PRINT(DEBUG_TAG, "detectByDistancePriority(image,detectedMarks,%d)", flags
  *
  * @param image Image with the QR code.
  * @param detectedMarks Recognized localization marks.
+ * @param context Context of the detection.
  * @param flags Match tolerance flags.
  */
-void QrDetector::_detect(Mat &image, DetectedMarks &detectedMarks, int flags) const {
+void QrDetector::_detect(Mat &image, DetectedMarks &detectedMarks, DetectContext &context, int flags) const {
 DEBUG_PRINT(DEBUG_TAG, "_detect(image,detectedMarks,%d)", flags);
 
-	vector<vector<Point> > drawVec;
-	Mat cropped, diff;
+	vector<uint64_t> packedCropped;
 	vector<vector<Point> > contours;
 	vector<Vec4i> hierarchy;
 	DetectedMark currMark;
-	Mat contourImage = image.clone();
-	Mat qrMark = QrBuildHelper::buildQrMark(QR_MARK_TEMPLATE_SIZE);
 	detectedMarks.clear();
 
 	// Retrieving the match tolerance and minimal size for finder pattern
 	double matchTolerance = QR_MARK_TAMPLATE_MATCH_TOLERANCE_NORMAL;
-	int markMinSize = QR_MARK_MINIMAL_SIZE_NORMAL;
+	int markMinSize = getMarkMinimalSize(flags);
 	if (flags & FLAG_QR_MARK_MATCH_TOLERANCE_HIGH) {
 		matchTolerance = QR_MARK_TAMPLATE_MATCH_TOLERANCE_HIGH;
-		markMinSize = QR_MARK_MINIMAL_SIZE_SMALL;
 	} else if (flags & FLAG_QR_MARK_MATCH_TOLERANCE_LOW) {
 		matchTolerance = QR_MARK_TAMPLATE_MATCH_TOLERANCE_LOW;
-		markMinSize = QR_MARK_MINIMAL_SIZE_LARGE;
 	}
 
+	// Fast path, clean finder patterns are found by the scanlines without the contours
+	if ((flags & FLAG_SCANLINE_FINDER) && !(flags & FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR)) {
+		QrScanlineFinder::find(image, detectedMarks, markMinSize);
+		if ((detectedMarks.size() > 2) && matchScanlineMarks(image, detectedMarks, matchTolerance, packedCropped)) {
+			int offset = context.reserveContourOffset(1);
+			for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+				detectedMarks[i].flags = flags & DISTANCE_FLAGS;
+				detectedMarks[i].variant = offset;
+			}
+			return;
+		}
+		detectedMarks.clear();
+	}
+
+	Mat contourImage = image.clone();
+
 	DEBUG_PRINT(DEBUG_TAG, "================ NEW DETECT CALL ================ ");
 	findContours(contourImage, contours, hierarchy, CV_RETR_TREE , CV_CHAIN_APPROX_SIMPLE);
 	//findContours(contourImage, contours, CV_RETR_LIST , CV_CHAIN_APPROX_SIMPLE);
+	int offset = context.reserveContourOffset(contours.size());
+
+	// Candidates are verified independently, the results are merged in the contour order
+	bool parallel = (flags & FLAG_PARALLEL_DETECTION) != 0;
+	vector<DetectedMark> marks;
+	vector<uchar> verified;
+	if (parallel) {
+		marks.resize(contours.size());
+		verified.resize(contours.size(), 0);
+
+		ThreadPool *threadPool = ThreadPool::getInstance();
+		int chunks = threadPool->getThreadsCount() * DETECTION_CHUNKS_PER_THREAD;
+		CandidatesTask task(*this, image, contours, hierarchy, flags, matchTolerance, markMinSize, marks, verified);
+		threadPool->parallelFor(0, contours.size(), max(((int)contours.size() + chunks - 1) / chunks, 1), task);
+	}
 
 	for( unsigned int i = 0; i < contours.size(); i++ ) {
-		if (contours[i].size() < 4) continue;
-		if (flags & FLAG_USE_HIERARCHY) {
-			if (hierarchy[i][2] < 0) continue;
-			if ((detectedMarks.size() > 0) && (currMark.variant != contourOffset + hierarchy[i][3])) continue;
+		if ((flags & FLAG_USE_HIERARCHY) && (detectedMarks.size() > 0) && (currMark.variant != offset + hierarchy[i][3])) continue;
+
+		if (parallel) {
+			if (!verified[i]) continue;
+			currMark = marks[i];
+		} else if (!verifyCandidate(image, contours, hierarchy, i, flags, matchTolerance, markMinSize, currMark, packedCropped)) {
+			continue;
 		}
 
-		//approxPolyDP(Mat(contours[i]), contours[i], 7, true);
+		currMark.variant = offset + hierarchy[i][3];
+		detectedMarks.push_back(currMark);
+	}
+}
 
-		RotatedRect box = minAreaRect(Mat(contours[i]));
-		Size2f boxSize = box.size;
-		Rect boxRect = box.boundingRect();
-		Size2f boxRectSize = boxRect.size();
+/**
+ * Verifies the finder patterns found by the scanlines with the template, the same as
+ * the contour candidates. Match ratios of the marks are set.
+ *
+ * @param image Binarized image.
+ * @param detectedMarks Finder patterns found by the scanlines.
+ * @param matchTolerance The match tolerance of the finder pattern template.
+ * @param packedCropped Buffer for the packed cropped finder pattern.
+ * @return True if all finder patterns match the template.
+ */
+bool QrDetector::matchScanlineMarks(Mat &image, DetectedMarks &detectedMarks, double matchTolerance,
+		vector<uint64_t> &packedCropped) const {
+	Mat cropped;
 
-		//>>> 1) FILTER BY CONTOUR SIZES
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		RotatedRect box = minAreaRect(Mat(detectedMarks[i].points));
+		double match = matchMarkTemplate(image, box, detectedMarks[i].points, false, cropped, packedCropped);
+		DEBUG_PRINT(DEBUG_TAG, "scanline mark match: %d : %.4f", i, match);
+		if ((match < 0) || (match > matchTolerance)) return false;
 
-		if ((boxSize.width / (double)boxSize.height > QR_MARK_BOUNDING_RECT_MAX_ACCEPTED_SCALE)
-			|| (boxSize.height / (double)boxSize.width > QR_MARK_BOUNDING_RECT_MAX_ACCEPTED_SCALE)
-			|| (boxSize.width < markMinSize) ||(boxSize.height < markMinSize)
-			|| (image.cols /(double) boxSize.width < QR_MARK_MAXIMAL_SIZE_RATIO)
-			|| (image.rows /(double) boxSize.height < QR_MARK_MAXIMAL_SIZE_RATIO))
-			continue;
+		detectedMarks[i].match = match;
+	}
+
+	return true;
+}
+
+/**
+ * Verifies whether the contour is the finder pattern (filters 0-7).
+ *
+ * @param image Binarized image.
+ * @param contours Contours of the binarized image.
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param i Index of the verified contour.
+ * @param flags Match tolerance/Repair flags.
+ * @param matchTolerance The match tolerance of the finder pattern template.
+ * @param markMinSize The minimal size of the finder pattern.
+ * @param currMark Output finder pattern (all attributes except the variant).
+ * @param packedCropped Buffer for the packed cropped candidate.
+ * @return True if the contour is the finder pattern.
+ */
+bool QrDetector::verifyCandidate(Mat &image, vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int i, int flags,
+		double matchTolerance, int markMinSize, DetectedMark &currMark, vector<uint64_t> &packedCropped) const {
+	Mat cropped;
+
+	if (contours[i].size() < 4) return false;
+
+	//>>> 0) FILTER BY NESTED CONTOURS
+
+	if (!isNestedMark(contours, hierarchy, i)) return false;
+
+	// Dark finder pattern is bordered by the hole, the inverted one by the light area
+	bool inverted = isLightContour(hierarchy, i);
+	if (inverted && !(flags & FLAG_DUAL_POLARITY)) return false;
+
+	//approxPolyDP(Mat(contours[i]), contours[i], 7, true);
+
+	RotatedRect box = minAreaRect(Mat(contours[i]));
+	Size2f boxSize = box.size;
+	Rect boxRect = box.boundingRect();
+	Size2f boxRectSize = boxRect.size();
+
+	//>>> 1) FILTER BY CONTOUR SIZES
+
+	if ((boxSize.width / (double)boxSize.height > QR_MARK_BOUNDING_RECT_MAX_ACCEPTED_SCALE)
+		|| (boxSize.height / (double)boxSize.width > QR_MARK_BOUNDING_RECT_MAX_ACCEPTED_SCALE)
+		|| (boxSize.width < markMinSize) ||(boxSize.height < markMinSize)
+		|| (image.cols /(double) boxSize.width < QR_MARK_MAXIMAL_SIZE_RATIO)
+		|| (image.rows /(double) boxSize.height < QR_MARK_MAXIMAL_SIZE_RATIO))
+		return false;
+
+	//>>> 2) FILTER BY BACKGROUND / FILL RATIO
+
+	// Pixel counts are estimated from the nested contours, masks are drawn only for the candidates passing all geometric filters
+	double contourFill = estimatePixelCount(contours[i], true);
+	double bgFill = (inverted)? estimateDarkPixelCount(contours, hierarchy, i) : estimateLightPixelCount(contours, hierarchy, i);
+
+	if (contourFill - bgFill < 1) return false;
+	if (bgFill < 1) return false;
+	double bgFillRatio = contourFill / bgFill;
+	DEBUG_PRINT(DEBUG_TAG, "bg/fill ratio: %d : %.4f", i, bgFillRatio);
+	if ((bgFillRatio > QR_MARK_BG_FILL_RATIO_MAX) || (bgFillRatio < QR_MARK_BG_FILL_RATIO_MIN)) return false;
+
+	// Converting the contour to the hull
+	vector<Point> hull;
+	convexHull(Mat(contours[i]), hull);
+
+	//>>> 3) FILTER BY CONTOUR / HULL MATCH
+
+	double hullFill = estimatePixelCount(hull, true);
+	DEBUG_PRINT(DEBUG_TAG, "cont/hull compare: %d : %.1f : %.1f : %d", i, contourFill, hullFill, boxRectSize.width * boxRectSize.height);
+	if (contourFill / hullFill < QR_MARK_CONVEX_CONTOUR_MATCH) return false;
+
+	//>>> 4) FILTER BY CORNER NUMBER
+
+	int pointSize = ceil((boxSize.width + boxSize.height) / 7.0); // divide 7 (as points), then 2 (as the width/height ratio) and multiply * 2 (gives better result in smaller images)
+	vector<Point> corners;
+	Polygon2D::findCorners(hull, 4, pointSize, corners, QR_MARK_MINIMAL_CORNER_ANGLE, QR_MARK_OPTIMAL_CORNER_ANGLE);
+	DEBUG_PRINT(DEBUG_TAG, "corners: %d", corners.size());
+	if (corners.size() != 4) return false;
+
+	//>>> 5) CONFIRMING THE BACKGROUND / FILL AND CONTOUR / HULL RATIOS BY THE MASKS
+
+	// First pixel access, estimates differ when the block size hollows the modules
+	int darkCount, lightCount, hullDarkCount, hullLightCount;
+	countMaskPixels(image, contours[i], boxRect, darkCount, lightCount);
+	int fillCount = (inverted)? lightCount : darkCount;
+	int bgCount = (inverted)? darkCount : lightCount;
+	if ((fillCount < 1) || (bgCount < 1)) return false;
+
+	bgFillRatio = (fillCount + bgCount) / (double)bgCount;
+	DEBUG_PRINT(DEBUG_TAG, "mask bg/fill ratio: %d : %.4f", i, bgFillRatio);
+	if ((bgFillRatio > QR_MARK_BG_FILL_RATIO_MAX) || (bgFillRatio < QR_MARK_BG_FILL_RATIO_MIN)) return false;
+
+	countMaskPixels(image, hull, boxRect, hullDarkCount, hullLightCount);
+	if ((fillCount + bgCount) / (double)(hullDarkCount + hullLightCount) < QR_MARK_CONVEX_CONTOUR_MATCH) return false;
+
+	//>>> 6) PERSPECTIVE TRANSFORMATION OF THE CONTOUR AND RESIZING FOR TEMPLATE COMPARING
+	//>>> 7) TEMPLATE COMAPARING OF THE FINDER PATTERN
+
+	double match = matchMarkTemplate(image, box, corners, inverted, cropped, packedCropped);
+	if (match < 0) return false;
+	DEBUG_PRINT(DEBUG_TAG, "First match result: %.4f", match);
+
+	currMark.flags = 0;
+	if (match > matchTolerance) {
+
+		// Trying to repair if possible
+		if (!(flags & FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR)) {
+			return false;
+		}
+		floodFill(cropped, Point(1, 1), Scalar(0));
+		floodFill(cropped, Point(1, cropped.rows - 2), Scalar(0));
+		floodFill(cropped, Point(cropped.cols - 2, 1), Scalar(0));
+		floodFill(cropped, Point(cropped.cols - 2, cropped.rows - 2), Scalar(0));
+
+		packBinarized(cropped, packedCropped);
+		match = exactMatchPacked(packedCropped, packedQrMark, cropped.cols);
+		if (match > matchTolerance) return false;
+		currMark.flags = FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR;
+	}
+
+	//>>> 8) STORING THE RESULT
+
+	DEBUG_PRINT(DEBUG_TAG, "mark match: %d : %.4f", i, match);
+
+	convexHull(corners, corners);
+	currMark.match = match;
+	currMark.flags = (flags & DISTANCE_FLAGS) | ((inverted)? FLAG_INVERTED_MARK : 0);
+	currMark.points = corners;
+	return true;
+}
+
+/**
+ * Matches the finder pattern inside the corners with the template. The box of the pattern
+ * is cropped, transformed to the square of the template size and binarized by the Otsu threshold.
+ *
+ * @param image Binarized image.
+ * @param box Minimal area rectangle of the finder pattern.
+ * @param corners Corners of the finder pattern.
+ * @param inverted Whether the finder pattern is light on the dark background.
+ * @param cropped Output transformed finder pattern.
+ * @param packedCropped Buffer for the packed cropped finder pattern.
+ * @return Ratio of the different pixels, negative if the pattern cannot be transformed.
+ */
+double QrDetector::matchMarkTemplate(Mat &image, const RotatedRect &box, vector<Point> &corners, bool inverted,
+		Mat &cropped, vector<uint64_t> &packedCropped) const {
+	Rect boxRect = box.boundingRect();
+	getRectSubPix(image, boxRect.size(), box.center, cropped);
+
+	vector<Point> offsetCorners = corners;
+	Polygon2D::offset(offsetCorners, Point(-boxRect.x, -boxRect.y));
+	cropped = warpPerspective(cropped, offsetCorners, true);
+	if (cropped.data == NULL) return -1;
+
+	resize(cropped, cropped, Size(QR_MARK_TEMPLATE_SIZE, QR_MARK_TEMPLATE_SIZE));
+	threshold(cropped, cropped, GLOBAL_THRESH, 255, (inverted)? CV_THRESH_OTSU | CV_THRESH_BINARY_INV : CV_THRESH_OTSU);
+
+	packBinarized(cropped, packedCropped);
+	return exactMatchPacked(packedCropped, packedQrMark, cropped.cols);
+}
+
+/**
+ * Tests whether the contour has the nested structure of the finder pattern, the light ring
+ * (child) and the center (grandchild) with the proper area ratios. Uses only the hierarchy
+ * and the contour areas, so it can reject the contours before any pixel access.
+ *
+ * @param contours Contours of the binarized image.
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param index Index of the tested contour.
+ * @return True if the contour can be the finder pattern.
+ */
+bool QrDetector::isNestedMark(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index) {
+	int child = hierarchy[index][2];
+	if ((child < 0) || (hierarchy[child][2] < 0)) return false;
 
-		MatND hist;
+	double area = contourArea(Mat(contours[index]));
+	if (area <= 0) return false;
 
-		// Getting the contour mask and cropping the image
-		Mat contourMask = Mat::zeros(boxRect.size(), CV_8UC1);
-		drawVec.push_back(contours[i]);
-	    drawContours(contourMask, contours, i, Scalar(255), CV_FILLED, 8, noArray(), INT_MAX, Point(-boxRect.x, -boxRect.y));
-		getRectSubPix(image, boxRect.size(), box.center, cropped);
+	// Noise inside the rings creates only small children, light ring is the largest one
+	double childArea, grandchildArea;
+	child = getLargestChild(contours, hierarchy, index, childArea);
+	if (getLargestChild(contours, hierarchy, child, grandchildArea) < 0) return false;
 
-		//>>> 2) FILTER BY HISTOGRAM MATCH
+	double childRatio = childArea / area;
+	if ((childRatio < QR_MARK_CHILD_AREA_RATIO_MIN) || (childRatio > QR_MARK_CHILD_AREA_RATIO_MAX)) return false;
 
-		calcBinarizedHistogram(cropped, contourMask, hist);
-        float fill_density = hist.at<float>(0);
-        float bg_density = hist.at<float>(1);
+	double grandchildRatio = grandchildArea / childArea;
+	return (grandchildRatio >= QR_MARK_GRANDCHILD_AREA_RATIO_MIN) && (grandchildRatio <= QR_MARK_GRANDCHILD_AREA_RATIO_MAX);
+}
+
+/**
+ * Estimates the number of the pixels covered by the filled contour by the Pick's theorem,
+ * the contour passes through the centers of its border pixels.
+ *
+ * @param contour Closed contour.
+ * @param includeBorder Whether to count the border pixels of the contour.
+ * @return Estimated number of the pixels.
+ */
+double QrDetector::estimatePixelCount(vector<Point> &contour, bool includeBorder) {
+	Mat contourMat(contour);
+	double area = contourArea(contourMat);
+	double halfBorder = countBorderPixels(contour) / 2.0;
 
-		if (fill_density < 1) continue;
-        double bgFillRatio = (fill_density + bg_density) / (double)bg_density;
-        DEBUG_PRINT(DEBUG_TAG, "hist match: %d : %.4f", i, bgFillRatio);
-        if ((bgFillRatio > QR_MARK_BG_FILL_RATIO_MAX) || (bgFillRatio < QR_MARK_BG_FILL_RATIO_MIN)) continue;
+	return (includeBorder)? area + halfBorder + 1 : std::max(area - halfBorder + 1, 0.0);
+}
 
-		// Converting the contour to the hull
-		vector<Point> hull;
-		convexHull(Mat(contours[i]), hull);
+/**
+ * Counts the lattice points on the border of the closed contour. Every segment
+ * of the contour is the digital line, so it passes through max(|dx|, |dy|) pixels.
+ *
+ * @param contour Closed contour.
+ * @return Number of the border pixels.
+ */
+int QrDetector::countBorderPixels(vector<Point> &contour) {
+	int count = 0;
 
-		//>>> 3) FILTER BY CONTOUR / HULL MATCH
+	for (unsigned int i = 0; i < contour.size(); i++) {
+		Point diff = contour[(i + 1) % contour.size()] - contour[i];
+		count += std::max(abs(diff.x), abs(diff.y));
+	}
 
-		Mat hullMask = Mat::zeros(boxRect.size(), CV_8UC1);
-		drawVec.clear(); drawVec.push_back(hull);
-	    drawContours(hullMask, drawVec, -1, Scalar(255), CV_FILLED, 8, noArray(), INT_MAX, Point(-boxRect.x, -boxRect.y));
-	    int contourFill = fill_density + bg_density;//cv::countNonZero(contourMask);
-	    int hullFill = cv::countNonZero(hullMask);
-        DEBUG_PRINT(DEBUG_TAG, "cont/hull compare: %d : %d : %d : %d", i, contourFill, hullFill, boxRectSize.width * boxRectSize.height);
-	    if (contourFill / (double) hullFill < QR_MARK_CONVEX_CONTOUR_MATCH) continue;
+	return count;
+}
 
-		//>>> 4) FILTER BY CORNER NUMBER
+/**
+ * Counts the dark and light pixels of the binarized image covered by the filled contour.
+ * The contour is drawn only inside the rectangle, pixels outside of the image are not counted.
+ *
+ * @param image Binarized image.
+ * @param contour Closed contour.
+ * @param rect Rectangle of the image which contains the contour.
+ * @param darkCount Output number of the dark pixels.
+ * @param lightCount Output number of the light pixels.
+ */
+void QrDetector::countMaskPixels(Mat &image, vector<Point> &contour, Rect rect, int &darkCount, int &lightCount) {
+	Rect imageRect = rect & Rect(0, 0, image.cols, image.rows);
+	darkCount = lightCount = 0;
+	if (imageRect.area() == 0) return;
 
-		int pointSize = ceil((boxSize.width + boxSize.height) / 7.0); // divide 7 (as points), then 2 (as the width/height ratio) and multiply * 2 (gives better result in smaller images)
-		vector<Point> corners;
-		Polygon2D::findCorners(hull, 4, pointSize, corners, QR_MARK_MINIMAL_CORNER_ANGLE, QR_MARK_OPTIMAL_CORNER_ANGLE);
-        DEBUG_PRINT(DEBUG_TAG, "corners: %d", corners.size());
-		if (corners.size() != 4) continue;
+	Mat mask = Mat::zeros(imageRect.size(), CV_8UC1);
+	vector<vector<Point> > drawVec(1, contour);
+	drawContours(mask, drawVec, 0, Scalar(255), CV_FILLED, 8, noArray(), INT_MAX, Point(-imageRect.x, -imageRect.y));
 
-		//>>> 5) PERSPECTIVE TRANSFORMATION OF THE CONTOUR AND RESIZING FOR TEMPLATE COMPARING
+	Mat masked;
+	bitwise_and(image(imageRect), mask, masked);
+	lightCount = countNonZero(masked);
+	darkCount = countNonZero(mask) - lightCount;
+}
 
-		vector<Point> offsetCorners = corners;
-		Polygon2D::offset(offsetCorners, Point(-boxRect.x, -boxRect.y));
-		cropped = warpPerspective(cropped, offsetCorners, true);
-		if (cropped.data == NULL) continue;
+/**
+ * Estimates the number of the light pixels inside the filled contour of the dark area.
+ * Border of the dark area lies on the light pixels, the light children are filled
+ * and their dark children (holes) are subtracted.
+ *
+ * @param contours Contours of the binarized image.
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param index Index of the contour of the dark area.
+ * @return Estimated number of the light pixels.
+ */
+double QrDetector::estimateLightPixelCount(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index) {
+	double light = countBorderPixels(contours[index]);
 
-		resize(cropped, cropped, Size(QR_MARK_TEMPLATE_SIZE, QR_MARK_TEMPLATE_SIZE));
-	    threshold(cropped, cropped, GLOBAL_THRESH, 255, CV_THRESH_OTSU);
+	for (int child = hierarchy[index][2]; child >= 0; child = hierarchy[child][0]) {
+		light += estimatePixelCount(contours[child], true);
+		for (int grandchild = hierarchy[child][2]; grandchild >= 0; grandchild = hierarchy[grandchild][0]) {
+			light -= estimatePixelCount(contours[grandchild], false);
+		}
+	}
 
-		//>>> 6) TEMPLATE COMAPARING OF THE FINDER PATTERN
+	return light;
+}
 
-	    double match = exactMatch(cropped, qrMark, diff);
-        DEBUG_PRINT(DEBUG_TAG, "First match result: %.4f", match);
+/**
+ * Estimates the number of the dark pixels inside the filled contour of the light area.
+ * Border of the light area lies on its own pixels, the dark holes are counted
+ * without their borders and their light children are subtracted.
+ *
+ * @param contours Contours of the binarized image.
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param index Index of the contour of the light area.
+ * @return Estimated number of the dark pixels.
+ */
+double QrDetector::estimateDarkPixelCount(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index) {
+	double dark = 0;
 
-	    currMark.flags = 0;
-	    if (match > matchTolerance) {
+	for (int child = hierarchy[index][2]; child >= 0; child = hierarchy[child][0]) {
+		dark += estimatePixelCount(contours[child], false);
+		for (int grandchild = hierarchy[child][2]; grandchild >= 0; grandchild = hierarchy[grandchild][0]) {
+			dark -= estimatePixelCount(contours[grandchild], true);
+		}
+	}
 
-	    	// Trying to repair if possible
-	    	if (!(flags & FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR)) {
-	    		continue;
-	    	}
-	    	floodFill(cropped, Point(1, 1), Scalar(0));
-	    	floodFill(cropped, Point(1, cropped.rows - 2), Scalar(0));
-	    	floodFill(cropped, Point(cropped.cols - 2, 1), Scalar(0));
-	    	floodFill(cropped, Point(cropped.cols - 2, cropped.rows - 2), Scalar(0));
+	return dark;
+}
 
-		    match = exactMatch(cropped, qrMark, diff);
-	    	if (match > matchTolerance) continue;
-	    	currMark.flags = FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR;
-	    }
+/**
+ * Tests whether the contour is the outer border of the light area. Contours
+ * of the tree hierarchy alternate the light areas (even depth) and the dark holes.
+ *
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param index Index of the tested contour.
+ * @return True if the contour encloses the light area.
+ */
+bool QrDetector::isLightContour(vector<Vec4i> &hierarchy, int index) {
+	bool light = true;
+	for (int parent = hierarchy[index][3]; parent >= 0; parent = hierarchy[parent][3]) {
+		light = !light;
+	}
 
-		//>>> 7) STORING THE RESULT
+	return light;
+}
 
-        DEBUG_PRINT(DEBUG_TAG, "mark match: %d : %.4f", i, match);
+/**
+ * Returns the child of the contour with the largest area.
+ *
+ * @param contours Contours of the binarized image.
+ * @param hierarchy Tree hierarchy of the contours.
+ * @param index Index of the parent contour.
+ * @param area Output area of the largest child.
+ * @return Index of the largest child or -1 if the contour has no child.
+ */
+int QrDetector::getLargestChild(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index, double &area) {
+	int largest = -1;
+	area = 0;
 
-	    convexHull(corners, corners);
-	    currMark.match = match;
-	    currMark.flags = flags & DISTANCE_FLAGS;
-	    currMark.points = corners;
-	    currMark.variant = contourOffset + hierarchy[i][3];
-	    detectedMarks.push_back(currMark);
+	for (int child = hierarchy[index][2]; child >= 0; child = hierarchy[child][0]) {
+		double childArea = contourArea(Mat(contours[child]));
+		if ((largest < 0) || (childArea > area)) {
+			largest = child;
+			area = childArea;
+		}
 	}
-	contourOffset += contours.size();
+
+	return largest;
 }
 
 /**
@@ -306,6 +1028,39 @@ int QrDetector::getBlockSize(Size imageSize, double distanceDivider) {
 	return (ret < 3)? 3 : ret + (ret + 1) % 2;
 }
 
+/**
+ * Calculates size of the block for adaptive threshold for specified distance flags.
+ *
+ * @param imageSize Size of the image.
+ * @param flags Flags for specifying the distance of the QR code.
+ * @return Size of the block for adaptive threshold.
+ */
+int QrDetector::getBlockSize(Size imageSize, int flags) {
+	if (flags & FLAG_DISTANCE_NEAR) {
+		return getBlockSize(imageSize, DISTANCE_NEAR_MEAN_BLOCK_SIZE_DIVIDER);
+	} else if (flags & FLAG_DISTANCE_FAR) {
+		return getBlockSize(imageSize, DISTANCE_FAR_MEAN_BLOCK_SIZE_DIVIDER);
+	} else {
+		return getBlockSize(imageSize, DISTANCE_MEDIUM_MEAN_BLOCK_SIZE_DIVIDER);
+	}
+}
+
+/**
+ * Returns the minimal size of the finder pattern for the match tolerance flags.
+ *
+ * @param flags Match tolerance flags.
+ * @return The minimal size of the finder pattern.
+ */
+int QrDetector::getMarkMinimalSize(int flags) {
+	if (flags & FLAG_QR_MARK_MATCH_TOLERANCE_HIGH) {
+		return QR_MARK_MINIMAL_SIZE_SMALL;
+	} else if (flags & FLAG_QR_MARK_MATCH_TOLERANCE_LOW) {
+		return QR_MARK_MINIMAL_SIZE_LARGE;
+	}
+
+	return QR_MARK_MINIMAL_SIZE_NORMAL;
+}
+
 /**
  * Binarize image to 0 and 255 values.
  *
@@ -315,24 +1070,73 @@ int QrDetector::getBlockSize(Size imageSize, double distanceDivider) {
  * @return Binarized image.
  */
 Mat QrDetector::binarize(Mat &image, int flags, int mean_C) {
+	if ((flags & FLAG_GLOBAL_THRESH) || (flags & FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR)) {
+		ThresholdCache thresholdCache(image, flags & FLAG_PARALLEL_BINARIZATION);
+		return binarize(thresholdCache, flags, mean_C);
+	}
+
+	// Single threshold, running sums are cheaper than the integral image of the cache
 	Mat binarized;
+	MeanThreshold::threshold(image, binarized, getBlockSize(Size(image.cols, image.rows), flags), mean_C,
+			flags & FLAG_PARALLEL_BINARIZATION);
+	if (flags & FLAG_INVERTED_MARK) {
+		bitwise_not(binarized, binarized);
+	}
+
+	DEBUG_WRITE_IMAGE(std::string("binarized_") + __DEBUG_TO_STR(flags) + std::string("_") + __DEBUG_TO_STR(mean_C) + std::string(".jpg") , binarized);
+	return binarized;
+}
+
+/**
+ * Binarize image of the threshold cache to 0 and 255 values.
+ * Every binarization (distance, threshold type, fill repair and polarity) is calculated
+ * only once for one image, all next calls return the cached result.
+ *
+ * @param thresholdCache Cache of the thresholds of the input image.
+ * @param flags Flags for specifying the distance of the QR code and type of threshold.
+ * @param mean_C Constant for adaptive threshold which offsets threshold value.
+ * @return Binarized image.
+ */
+Mat QrDetector::binarize(ThresholdCache &thresholdCache, int flags, int mean_C) {
+	Mat image = thresholdCache.getImage();
+	Mat binarized;
+
+	// Inverted binarization is derived from the plain one and cached beside it
+	if (flags & FLAG_INVERTED_MARK) {
+		int blockSize = (flags & FLAG_GLOBAL_THRESH)? 0 : getBlockSize(Size(image.cols, image.rows), flags);
+		int variant = FLAG_INVERTED_MARK | (flags & (FLAG_GLOBAL_THRESH | FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR));
+		if (thresholdCache.getBinarized(blockSize, mean_C, variant, binarized)) {
+			return binarized;
+		}
+
+		bitwise_not(binarize(thresholdCache, flags & ~FLAG_INVERTED_MARK, mean_C), binarized);
+		thresholdCache.setBinarized(blockSize, mean_C, variant, binarized);
+		return binarized;
+	}
 
 	if (flags & FLAG_GLOBAL_THRESH) {
+		if (thresholdCache.getBinarized(0, 0, FLAG_GLOBAL_THRESH, binarized)) {
+			return binarized;
+		}
+
 		threshold(image, binarized, GLOBAL_THRESH, 255, CV_THRESH_OTSU);
+		thresholdCache.setBinarized(0, 0, FLAG_GLOBAL_THRESH, binarized);
 	} else {
-		int blockSize;
-		if (flags & FLAG_DISTANCE_NEAR) {
-			blockSize = getBlockSize(Size(image.cols, image.rows), DISTANCE_NEAR_MEAN_BLOCK_SIZE_DIVIDER);
-		} else if (flags & FLAG_DISTANCE_FAR) {
-			blockSize = getBlockSize(Size(image.cols, image.rows), DISTANCE_FAR_MEAN_BLOCK_SIZE_DIVIDER);
-		} else {
-			blockSize = getBlockSize(Size(image.cols, image.rows), DISTANCE_MEDIUM_MEAN_BLOCK_SIZE_DIVIDER);
+		int blockSize = getBlockSize(Size(image.cols, image.rows), flags);
+
+		if (!(flags & FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR)) {
+			return thresholdCache.adaptiveThreshold(blockSize, mean_C);
 		}
 
-		adaptiveThreshold(image, binarized, 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY, blockSize, mean_C);
-		if (flags & FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR) {
-			fillMissing(binarized, image, EDGE_DETECT_MEAN_BLOCK_SIZE, MEAN_BLOCK_SIZE, EDGE_DETECT_MEAN_C, ROW_CUTS);
+		if (thresholdCache.getBinarized(blockSize, mean_C, FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR, binarized)) {
+			return binarized;
 		}
+
+		// Repairing the copy of the plain threshold, cached threshold must stay untouched
+		binarized = thresholdCache.adaptiveThreshold(blockSize, mean_C).clone();
+		fillMissingFromMeans(binarized, thresholdCache.mean(MEAN_BLOCK_SIZE), EDGE_DETECT_MEAN_BLOCK_SIZE, MEAN_BLOCK_SIZE,
+				EDGE_DETECT_MEAN_C, ROW_CUTS, thresholdCache.isParallel());
+		thresholdCache.setBinarized(blockSize, mean_C, FLAG_ADAPT_THRESH_CORRUPT_FILL_REPAIR, binarized);
 	}
 
 	DEBUG_WRITE_IMAGE(std::string("binarized_") + __DEBUG_TO_STR(flags) + std::string("_") + __DEBUG_TO_STR(mean_C) + std::string(".jpg") , binarized);
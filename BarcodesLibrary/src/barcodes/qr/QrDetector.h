@@ -21,6 +21,9 @@
 #define QRDETECTOR_H_
 
 #include "../Detector.h"
+#include "../DetectContext.h"
+#include "../../common/ThresholdCache.h"
+#include "../../common/Deadline.h"
 
 namespace barcodes {
 using namespace std;
@@ -28,6 +31,7 @@ using namespace cv;
 
 /**
  * Class of the singleton used for detection of QR code in the image.
+ * Detector is immutable, mutable state of the detection is kept in DetectContext.
  */
 class QrDetector: public Detector {
 public:
@@ -117,6 +121,84 @@ public:
 	 */
 	static const int FLAG_USE_HIERARCHY                    = 0x0800;
 
+	/**
+	 * Binarization flag. Binarizes the horizontal bands of the image on the shared
+	 * thread pool. Result is the same as of the serial binarization.
+	 */
+	static const int FLAG_PARALLEL_BINARIZATION            = 0x1000;
+
+	/**
+	 * Detection flag. Finds the finder patterns by the run lengths of the rows
+	 * and columns first, contours are searched only if it does not find all three patterns.
+	 *
+	 * @see QrScanlineFinder
+	 */
+	static const int FLAG_SCANLINE_FINDER                  = 0x2000;
+
+	/**
+	 * Detection flag. Verifies the finder pattern candidates (contours) on the shared
+	 * thread pool. Detected marks are the same as of the serial detection.
+	 */
+	static const int FLAG_PARALLEL_DETECTION               = 0x4000;
+
+	/**
+	 * Detection flag. Detects all enabled distances concurrently on the shared thread pool
+	 * and cancels the farther distances once the nearer ones have found the marks.
+	 * Detected marks are the same as of the sequential detection by distance priority.
+	 */
+	static const int FLAG_PARALLEL_DISTANCES               = 0x8000;
+
+	/**
+	 * Detection flag. Detects the finder patterns on the downscaled image (2x or 4x)
+	 * and refines them in the small full resolution windows around the hits.
+	 * Full resolution detection is used if the downscaled image does not contain the marks.
+	 *
+	 * @see PYRAMID_MIN_LEVEL_SIZE
+	 */
+	static const int FLAG_PYRAMID_DETECTION                = 0x10000;
+
+	/**
+	 * Detection flag. Runs the repair passes and distances in the order given by the statistics
+	 * of the successful decodes, the most successful and cheapest combinations first.
+	 * Marks are detected sequentially and their attempt holds the repair and distance flags.
+	 *
+	 * @see QrDetectionScheduler
+	 */
+	static const int FLAG_ADAPTIVE_SCHEDULING              = 0x20000;
+
+	/**
+	 * Detection flag. Tests cheaply on the sparse rows of the image whether there can be
+	 * any finder pattern, images without the plausible pattern are not detected at all.
+	 * It is useful when most of the images do not contain any QR code.
+	 *
+	 * @see QrScanlineFinder::isPresent
+	 */
+	static const int FLAG_PRESENCE_TEST                    = 0x40000;
+
+	/**
+	 * Decoding flag. Groups of the marks of the image with more QR codes are decoded
+	 * concurrently in the thread pool.
+	 *
+	 * @see QrDecoder::decode
+	 */
+	static const int FLAG_PARALLEL_DECODING                = 0x80000;
+
+	/**
+	 * Detection flag. Accepts also the light finder patterns on the dark background
+	 * (inverted codes). Both polarities are taken from the contours of the same
+	 * binarization, inverted codes do not need the second pass.
+	 *
+	 * @see FLAG_INVERTED_MARK
+	 */
+	static const int FLAG_DUAL_POLARITY                    = 0x100000;
+
+	/**
+	 * Mark flag. The mark is light on the dark background, it is set by the detection
+	 * with FLAG_DUAL_POLARITY. Binarizations with this flag are inverted, so the sampling
+	 * of the inverted code sees the same polarity as of the normal code.
+	 */
+	static const int FLAG_INVERTED_MARK                    = 0x200000;
+
 	/**
 	 * Groups all repair flags.
 	 */
@@ -140,7 +222,108 @@ public:
 	 * @param flags Detection flags.
 	 */
 	void detect(Image &image, DetectedMarks &detectedMarks, int flags = FLAG_ADAPT_THRESH | REPAIR_FLAGS |
-			DISTANCE_FLAGS | FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL) const;
+			DISTANCE_FLAGS | FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Detects QR code and returns localization marks.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param flags Detection flags.
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, int flags = FLAG_ADAPT_THRESH | REPAIR_FLAGS |
+			DISTANCE_FLAGS | FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Detects QR code and returns localization marks found until the deadline.
+	 * Deadline is checked before every repair pass and distance, it is exceeded
+	 * if some of them has been skipped.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param deadline Deadline of the detection.
+	 * @param flags Detection flags.
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, const Deadline &deadline,
+			int flags = FLAG_ADAPT_THRESH | REPAIR_FLAGS | DISTANCE_FLAGS | FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL |
+			FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Detects QR code and returns localization marks found until the deadline.
+	 * All mutable state of the detection is kept in the context, so more threads
+	 * can detect at once, each of them with its own context.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection, it is reset at the start.
+	 * @param deadline Deadline of the detection.
+	 * @param flags Detection flags.
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			const Deadline &deadline, int flags = FLAG_ADAPT_THRESH | REPAIR_FLAGS | DISTANCE_FLAGS |
+			FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Detects QR code only inside the regions of the image (with the margin)
+	 * and returns localization marks in the coordinates of the whole image.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param regions Regions of the image where the QR code can be.
+	 * @param flags Detection flags.
+	 *
+	 * @see getSearchRegion
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, int flags = FLAG_ADAPT_THRESH |
+			REPAIR_FLAGS | DISTANCE_FLAGS | FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Detects QR code only inside the regions of the image (with the margin) until
+	 * the deadline and returns localization marks in the coordinates of the whole image.
+	 * Binarization and contours are calculated only for the regions.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param regions Regions of the image where the QR code can be.
+	 * @param context Context of the detection, it is reset at the start.
+	 * @param deadline Deadline of the detection, checked also before every region.
+	 * @param flags Detection flags.
+	 *
+	 * @see getSearchRegion
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, const vector<Rect> &regions, DetectContext &context,
+			const Deadline &deadline, int flags = FLAG_ADAPT_THRESH | REPAIR_FLAGS | DISTANCE_FLAGS |
+			FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
+
+	/**
+	 * Returns the region extended by the margin and clipped by the image. The margin
+	 * covers the finder patterns which reach out of the region.
+	 *
+	 * @param region Region of the image where the QR code can be.
+	 * @param imageSize Size of the image.
+	 * @return Searched region, empty if the region is outside the image.
+	 *
+	 * @see REGION_MARGIN_RATIO
+	 */
+	static Rect getSearchRegion(const Rect &region, Size imageSize);
+
+	/**
+	 * Detects QR code in one pass with the adaptive threshold of the specified block size,
+	 * distance and repair flags are ignored. It serves for the detection when the size
+	 * of the modules is already known (e.g. tracking of the QR code).
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection, it is reset at the start.
+	 * @param blockSize Size of the block for adaptive threshold (odd number).
+	 * @param flags Match tolerance/Scanline finder flags.
+	 */
+	void detectWithBlockSize(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			int blockSize, int flags = FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | FLAG_SCANLINE_FINDER) const;
 
 	/**
 	 * Returns instance of the QR detector.
@@ -158,17 +341,61 @@ public:
 	 * @return Binarized image.
 	 */
 	static Mat binarize(Mat &image, int flags, int mean_C = BINARIZE_MEAN_C);
+
+	/**
+	 * Binarize image of the threshold cache to 0 and 255 values.
+	 * Every binarization (distance, threshold type, fill repair and polarity) is calculated
+	 * only once for one image, all next calls return the cached result.
+	 * Returned image shares the data with the cache and must not be modified.
+	 *
+	 * @param thresholdCache Cache of the thresholds of the input image.
+	 * @param flags Flags for specifying the distance of the QR code and type of threshold.
+	 * @param mean_C Constant for adaptive threshold which offsets threshold value.
+	 * @return Binarized image.
+	 */
+	static Mat binarize(ThresholdCache &thresholdCache, int flags, int mean_C = BINARIZE_MEAN_C);
 protected:
+	class CandidatesTask;
+	friend class CandidatesTask;
+	class DistancesTask;
+	friend class DistancesTask;
+
 	/**
-	 * Offset for storing contours indices. Is changed every time after detect call.
+	 * Finder pattern template for the exact match, packed once for all detections.
 	 */
-	mutable int contourOffset;
+	vector<uint64_t> packedQrMark;
 
 	/**
 	 * Instance of the QR detector.
 	 */
 	static const QrDetector DETECTOR_INSTANCE;
 
+	/**
+	 * Number of the parallel chunks of the candidates per one thread (balances the load of the threads).
+	 */
+	static const int DETECTION_CHUNKS_PER_THREAD                =    4;
+
+	/**
+	 * The minimal size of the shorter side of the downscaled image for the pyramid detection.
+	 *
+	 * @see FLAG_PYRAMID_DETECTION
+	 */
+	static const int PYRAMID_MIN_LEVEL_SIZE                     =    480;
+
+	/**
+	 * The margin added to every side of the region of interest, ratio of the longer side of the region.
+	 *
+	 * @see getSearchRegion
+	 */
+	static const double REGION_MARGIN_RATIO                     =    0.25;
+
+	/**
+	 * The maximal downscale of the image for the pyramid detection.
+	 *
+	 * @see FLAG_PYRAMID_DETECTION
+	 */
+	static const int PYRAMID_MAX_SCALE                          =    4;
+
 	/**
 	 * The number of samples which will be used for counting average mean on the row
 	 * in the fillMissing function.
@@ -310,6 +537,30 @@ protected:
 	 */
 	static const double QR_MARK_TAMPLATE_MATCH_TOLERANCE_LOW    =    0.1;
 
+	/**
+	 * (Detection filter) The minimal accepted area ratio of the light ring (5x5) and the mark (7x7)
+	 * contours (reference 25 / 49).
+	 */
+	static const double QR_MARK_CHILD_AREA_RATIO_MIN            =    0.15;
+
+	/**
+	 * (Detection filter) The maximal accepted area ratio of the light ring (5x5) and the mark (7x7)
+	 * contours (reference 25 / 49).
+	 */
+	static const double QR_MARK_CHILD_AREA_RATIO_MAX            =    0.85;
+
+	/**
+	 * (Detection filter) The minimal accepted area ratio of the center (3x3) and the light ring (5x5)
+	 * contours (reference 9 / 25).
+	 */
+	static const double QR_MARK_GRANDCHILD_AREA_RATIO_MIN       =    0.15;
+
+	/**
+	 * (Detection filter) The maximal accepted area ratio of the center (3x3) and the light ring (5x5)
+	 * contours (reference 9 / 25).
+	 */
+	static const double QR_MARK_GRANDCHILD_AREA_RATIO_MAX       =    0.85;
+
 	/**
 	 * The minimal size which can have finder pattern. (Small)
 	 */
@@ -325,7 +576,7 @@ protected:
 	 */
 	static const int QR_MARK_MINIMAL_SIZE_LARGE                 =    20;
 
-	QrDetector() : contourOffset(0) {}
+	QrDetector();
 	virtual ~QrDetector() {}
 
 	/**
@@ -333,18 +584,230 @@ protected:
 	 *
 	 * @param image Image with the QR code.
 	 * @param detectedMarks Recognized localization marks.
+	 * @param context Context of the detection.
 	 * @param flags Match tolerance/Repair flags.
 	 */
-	void _detect(Mat &image,DetectedMarks &detectedMarks, int flags = 0) const;
+	void _detect(Mat &image,DetectedMarks &detectedMarks, DetectContext &context, int flags = 0) const;
+
+	/**
+	 * Verifies the finder patterns found by the scanlines with the template, the same as
+	 * the contour candidates. Match ratios of the marks are set.
+	 *
+	 * @param image Binarized image.
+	 * @param detectedMarks Finder patterns found by the scanlines.
+	 * @param matchTolerance The match tolerance of the finder pattern template.
+	 * @param packedCropped Buffer for the packed cropped finder pattern.
+	 * @return True if all finder patterns match the template.
+	 */
+	bool matchScanlineMarks(Mat &image, DetectedMarks &detectedMarks, double matchTolerance, vector<uint64_t> &packedCropped) const;
+
+	/**
+	 * Verifies whether the contour is the finder pattern (filters 0-7).
+	 *
+	 * @param image Binarized image.
+	 * @param contours Contours of the binarized image.
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param i Index of the verified contour.
+	 * @param flags Match tolerance/Repair flags.
+	 * @param matchTolerance The match tolerance of the finder pattern template.
+	 * @param markMinSize The minimal size of the finder pattern.
+	 * @param currMark Output finder pattern (all attributes except the variant).
+	 * @param packedCropped Buffer for the packed cropped candidate.
+	 * @return True if the contour is the finder pattern.
+	 */
+	bool verifyCandidate(Mat &image, vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int i, int flags,
+			double matchTolerance, int markMinSize, DetectedMark &currMark, vector<uint64_t> &packedCropped) const;
+
+	/**
+	 * Matches the finder pattern inside the corners with the template. The box of the pattern
+	 * is cropped, transformed to the square of the template size and binarized by the Otsu threshold.
+	 *
+	 * @param image Binarized image.
+	 * @param box Minimal area rectangle of the finder pattern.
+	 * @param corners Corners of the finder pattern.
+	 * @param inverted Whether the finder pattern is light on the dark background.
+	 * @param cropped Output transformed finder pattern.
+	 * @param packedCropped Buffer for the packed cropped finder pattern.
+	 * @return Ratio of the different pixels, negative if the pattern cannot be transformed.
+	 */
+	double matchMarkTemplate(Mat &image, const RotatedRect &box, vector<Point> &corners, bool inverted,
+			Mat &cropped, vector<uint64_t> &packedCropped) const;
+
+	/**
+	 * Tests whether the contour has the nested structure of the finder pattern, the light ring
+	 * (child) and the center (grandchild) with the proper area ratios. Uses only the hierarchy
+	 * and the contour areas, so it can reject the contours before any pixel access.
+	 *
+	 * @param contours Contours of the binarized image.
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param index Index of the tested contour.
+	 * @return True if the contour can be the finder pattern.
+	 */
+	static bool isNestedMark(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index);
+
+	/**
+	 * Estimates the number of the pixels covered by the filled contour by the Pick's theorem,
+	 * the contour passes through the centers of its border pixels.
+	 *
+	 * @param contour Closed contour.
+	 * @param includeBorder Whether to count the border pixels of the contour.
+	 * @return Estimated number of the pixels.
+	 */
+	static double estimatePixelCount(vector<Point> &contour, bool includeBorder);
+
+	/**
+	 * Counts the lattice points on the border of the closed contour. Every segment
+	 * of the contour is the digital line, so it passes through max(|dx|, |dy|) pixels.
+	 *
+	 * @param contour Closed contour.
+	 * @return Number of the border pixels.
+	 */
+	static int countBorderPixels(vector<Point> &contour);
+
+	/**
+	 * Counts the dark and light pixels of the binarized image covered by the filled contour.
+	 * The contour is drawn only inside the rectangle, pixels outside of the image are not counted.
+	 *
+	 * @param image Binarized image.
+	 * @param contour Closed contour.
+	 * @param rect Rectangle of the image which contains the contour.
+	 * @param darkCount Output number of the dark pixels.
+	 * @param lightCount Output number of the light pixels.
+	 */
+	static void countMaskPixels(Mat &image, vector<Point> &contour, Rect rect, int &darkCount, int &lightCount);
+
+	/**
+	 * Estimates the number of the light pixels inside the filled contour of the dark area.
+	 * Border of the dark area lies on the light pixels, the light children are filled
+	 * and their dark children (holes) are subtracted.
+	 *
+	 * @param contours Contours of the binarized image.
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param index Index of the contour of the dark area.
+	 * @return Estimated number of the light pixels.
+	 */
+	static double estimateLightPixelCount(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index);
+
+	/**
+	 * Estimates the number of the dark pixels inside the filled contour of the light area.
+	 * Border of the light area lies on its own pixels, the dark holes are counted
+	 * without their borders and their light children are subtracted.
+	 *
+	 * @param contours Contours of the binarized image.
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param index Index of the contour of the light area.
+	 * @return Estimated number of the dark pixels.
+	 */
+	static double estimateDarkPixelCount(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index);
+
+	/**
+	 * Tests whether the contour is the outer border of the light area. Contours
+	 * of the tree hierarchy alternate the light areas (even depth) and the dark holes.
+	 *
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param index Index of the tested contour.
+	 * @return True if the contour encloses the light area.
+	 */
+	static bool isLightContour(vector<Vec4i> &hierarchy, int index);
+
+	/**
+	 * Returns the child of the contour with the largest area.
+	 *
+	 * @param contours Contours of the binarized image.
+	 * @param hierarchy Tree hierarchy of the contours.
+	 * @param index Index of the parent contour.
+	 * @param area Output area of the largest child.
+	 * @return Index of the largest child or -1 if the contour has no child.
+	 */
+	static int getLargestChild(vector<vector<Point> > &contours, vector<Vec4i> &hierarchy, int index, double &area);
 
 	/**
 	 * Detects QR code and returns localization marks.
 	 *
-	 * @param image Image with the QR code.
 	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection.
+	 * @param deadline Deadline of the detection, checked before every distance.
 	 * @param flags Match tolerance/Distance/Repair flags.
 	 */
-	void detectByDistancePriority(Image &image,DetectedMarks &detectedMarks, int flags) const;
+	void detectByDistancePriority(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			const Deadline &deadline, int flags) const;
+
+	/**
+	 * Detects QR code and returns localization marks found until the deadline.
+	 * Context is not reset, so the marks of more detections can be merged.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection.
+	 * @param deadline Deadline of the detection.
+	 * @param flags Detection flags.
+	 */
+	void detectMarks(Image &image, DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			const Deadline &deadline, int flags) const;
+
+	/**
+	 * Detects QR code by the attempts (repair and distance flags) in the order
+	 * of the detection scheduler. Time of every attempt is recorded, marks are merged
+	 * in the same way as by the detection by distance priority.
+	 *
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection.
+	 * @param deadline Deadline of the detection, checked before every attempt.
+	 * @param flags Detection flags.
+	 */
+	void detectBySchedule(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			const Deadline &deadline, int flags) const;
+
+	/**
+	 * Detects the marks on the downscaled image and refines them in the full resolution.
+	 *
+	 * @param image Image with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param context Context of the detection.
+	 * @param deadline Deadline of the detection.
+	 * @param flags Detection flags.
+	 * @return True if the marks have been found on the downscaled image.
+	 */
+	bool detectOnPyramid(Image &image, DetectedMarks &detectedMarks, DetectContext &context, const Deadline &deadline, int flags) const;
+
+	/**
+	 * Refines the mark found on the downscaled image in the full resolution window around it.
+	 * Points of the mark are kept if the mark is not found inside the window.
+	 *
+	 * @param image Full resolution image.
+	 * @param mark Mark with the points mapped to the full resolution.
+	 * @param context Context of the detection.
+	 * @param flags Match tolerance/Repair flags.
+	 */
+	void refineMark(Mat &image, DetectedMark &mark, DetectContext &context, int flags) const;
+
+	/**
+	 * Detects all enabled distances concurrently on the shared thread pool. Farther
+	 * distances are cancelled once the nearer ones have found the marks, the result
+	 * is the same as of the sequential detection.
+	 *
+	 * @param detectedMarks Recognized localization marks.
+	 * @param thresholdCache Cache of the thresholds of the image.
+	 * @param context Context of the detection.
+	 * @param deadline Deadline of the detection, distances not started before it are skipped.
+	 * @param distanceFlags Distances which should be detected.
+	 * @param flags Match tolerance/Repair flags.
+	 */
+	void detectDistancesInParallel(DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, DetectContext &context,
+			const Deadline &deadline, int distanceFlags, int flags) const;
+
+	/**
+	 * Merges the marks of one distance into the marks of the nearer distances.
+	 *
+	 * @param detectedMarks Marks of the nearer distances.
+	 * @param marks Marks of the distance.
+	 * @param distanceFlag Flag of the distance.
+	 * @return True if enough marks have been found and the farther distances are not needed.
+	 */
+	static bool mergeDistanceMarks(DetectedMarks &detectedMarks, DetectedMarks &marks, int distanceFlag);
 
 	/**
 	 * Calculates size of the block for adaptive threshold for specified distance divider.
@@ -354,6 +817,23 @@ protected:
 	 * @return Size of the block for adaptive threshold.
 	 */
 	static int getBlockSize(Size imageSize, double distanceDivider);
+
+	/**
+	 * Calculates size of the block for adaptive threshold for specified distance flags.
+	 *
+	 * @param imageSize Size of the image.
+	 * @param flags Flags for specifying the distance of the QR code.
+	 * @return Size of the block for adaptive threshold.
+	 */
+	static int getBlockSize(Size imageSize, int flags);
+
+	/**
+	 * Returns the minimal size of the finder pattern for the match tolerance flags.
+	 *
+	 * @param flags Match tolerance flags.
+	 * @return The minimal size of the finder pattern.
+	 */
+	static int getMarkMinimalSize(int flags);
 };
 
 } /* namespace barcodes */
@@ -0,0 +1,260 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrMarkGrouper.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of QrMarkGrouper class which groups the detected
+//             marks into the triples of the finder patterns of the QR codes.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrMarkGrouper.cpp
+ *
+ * @brief Defines members of QrMarkGrouper class which groups the detected
+ *        marks into the triples of the finder patterns of the QR codes.
+ * @author agent agent(at)local
+ */
+
+#include <cmath>
+#include <algorithm>
+
+#include "../../debug.h"
+#include "QrMarkGrouper.h"
+#include "QrDetector.h"
+
+#define DEBUG_TAG "QrMarkGrouper.cpp"
+
+namespace barcodes {
+
+/**
+ * Finds all consistent triples of the marks.
+ *
+ * @param detectedMarks Detected marks.
+ * @param triples Output consistent triples sorted by the error, the best first.
+ */
+void QrMarkGrouper::findTriples(const DetectedMarks &detectedMarks, vector<Triple> &triples) {
+	triples.clear();
+	int count = detectedMarks.size();
+
+	vector<MarkShape> shapes(count);
+	for (int i = 0; i < count; i++) {
+		getShape(detectedMarks[i], shapes[i]);
+	}
+
+	// Only the marks in the distance of the leg can be the ends of the legs
+	vector<vector<int> > neighbours(count);
+	for (int i = 0; i < count; i++) {
+		for (int j = i + 1; j < count; j++) {
+			float moduleSize = (shapes[i].moduleSize + shapes[j].moduleSize) / 2;
+			double legModules = norm(shapes[j].center - shapes[i].center) / moduleSize;
+			if ((legModules >= GROUP_LEG_MODULES_MIN) && (legModules <= GROUP_LEG_MODULES_MAX)) {
+				neighbours[i].push_back(j);
+				neighbours[j].push_back(i);
+			}
+		}
+	}
+
+	Triple triple;
+	for (int i = 0; i < count; i++) {
+		for (unsigned int j = 0; j < neighbours[i].size(); j++) {
+			for (unsigned int k = j + 1; k < neighbours[i].size(); k++) {
+				triple.corner = i;
+				triple.ends[0] = neighbours[i][j];
+				triple.ends[1] = neighbours[i][k];
+
+				if (isConsistent(shapes[triple.corner], shapes[triple.ends[0]], shapes[triple.ends[1]], triple.error)) {
+					triples.push_back(triple);
+				}
+			}
+		}
+	}
+
+	stable_sort(triples.begin(), triples.end());
+	DEBUG_PRINT(DEBUG_TAG, "marks: %d, consistent triples: %d", count, triples.size());
+}
+
+/**
+ * Groups the marks into the disjoint triples, better triples are taken first.
+ *
+ * @param detectedMarks Detected marks.
+ * @param groups Output groups of three marks, the best first.
+ */
+void QrMarkGrouper::groupMarks(const DetectedMarks &detectedMarks, vector<DetectedMarks> &groups) {
+	vector<Triple> triples;
+	findTriples(detectedMarks, triples);
+
+	groups.clear();
+	vector<uchar> used(detectedMarks.size(), 0);
+	for (unsigned int i = 0; i < triples.size(); i++) {
+		const Triple &triple = triples[i];
+		if (used[triple.corner] || used[triple.ends[0]] || used[triple.ends[1]]) continue;
+
+		used[triple.corner] = used[triple.ends[0]] = used[triple.ends[1]] = 1;
+
+		groups.push_back(DetectedMarks());
+		groups.back().push_back(detectedMarks[triple.corner]);
+		groups.back().push_back(detectedMarks[triple.ends[0]]);
+		groups.back().push_back(detectedMarks[triple.ends[1]]);
+	}
+}
+
+/**
+ * Finds all consistent triples of the marks and ranks them by the geometric error
+ * and the continuity of the timing patterns between the marks.
+ *
+ * @param detectedMarks Detected marks.
+ * @param thresholdCache Cache of the thresholds of the image, marks are sampled in their binarization.
+ * @param triples Output consistent triples sorted by the total error, the best first.
+ */
+void QrMarkGrouper::rankTriples(const DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, vector<Triple> &triples) {
+	findTriples(detectedMarks, triples);
+
+	vector<MarkShape> shapes(detectedMarks.size());
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		getShape(detectedMarks[i], shapes[i]);
+	}
+
+	for (unsigned int i = 0; i < triples.size(); i++) {
+		Triple &triple = triples[i];
+		Mat binarized = QrDetector::binarize(thresholdCache, detectedMarks[triple.corner].flags);
+		double continuity = getTimingContinuity(binarized, shapes[triple.corner], shapes[triple.ends[0]], shapes[triple.ends[1]]);
+		triple.error += GROUP_TIMING_ERROR_WEIGHT * (1 - continuity);
+	}
+
+	stable_sort(triples.begin(), triples.end());
+}
+
+/**
+ * Returns the shape of the mark.
+ *
+ * @param mark Detected mark.
+ * @param shape Output shape of the mark.
+ */
+void QrMarkGrouper::getShape(const DetectedMark &mark, MarkShape &shape) {
+	const RotatedRect &box = mark.getBox();
+
+	// Finder pattern is 7 modules wide
+	shape.center = box.center;
+	shape.moduleSize = (box.size.width + box.size.height) / 14;
+	shape.angle = box.angle;
+}
+
+/**
+ * Returns the deviation of the sides of the mark from the direction.
+ *
+ * @param shape Shape of the mark.
+ * @param direction Direction of the leg.
+ * @return Deviation in the degrees (0 - 45).
+ */
+double QrMarkGrouper::getOrientationError(const MarkShape &shape, const Point2f &direction) {
+	double directionAngle = atan2(direction.y, direction.x) * 180 / CV_PI;
+	double deviation = fmod(fabs(directionAngle - shape.angle), 90.0);
+
+	return min(deviation, 90 - deviation);
+}
+
+/**
+ * Tests whether the marks can be the finder patterns of one QR code and calculates the error.
+ *
+ * @param corner Shape of the mark in the corner.
+ * @param end1 Shape of the mark at the end of the first leg.
+ * @param end2 Shape of the mark at the end of the second leg.
+ * @param error Output error of the triple.
+ * @return True if the triple is consistent.
+ */
+bool QrMarkGrouper::isConsistent(const MarkShape &corner, const MarkShape &end1, const MarkShape &end2, double &error) {
+	Point2f leg1 = end1.center - corner.center;
+	Point2f leg2 = end2.center - corner.center;
+	double leg1Length = norm(leg1);
+	double leg2Length = norm(leg2);
+	if ((leg1Length == 0) || (leg2Length == 0)) return false;
+
+	// Similar module sizes
+	float minModuleSize = min(corner.moduleSize, min(end1.moduleSize, end2.moduleSize));
+	float maxModuleSize = max(corner.moduleSize, max(end1.moduleSize, end2.moduleSize));
+	if ((minModuleSize <= 0) || (maxModuleSize / minModuleSize > GROUP_MODULE_SIZE_RATIO_MAX)) return false;
+	double moduleRatio = maxModuleSize / minModuleSize;
+
+	// Legs of the similar lengths
+	double legRatio = max(leg1Length, leg2Length) / min(leg1Length, leg2Length);
+	if (legRatio > GROUP_LEG_RATIO_MAX) return false;
+
+	double moduleSize = (corner.moduleSize + end1.moduleSize + end2.moduleSize) / 3;
+	if ((min(leg1Length, leg2Length) / moduleSize < GROUP_LEG_MODULES_MIN)
+			|| (max(leg1Length, leg2Length) / moduleSize > GROUP_LEG_MODULES_MAX)) return false;
+
+	// Right angle in the corner
+	double cosAngle = leg1.dot(leg2) / (leg1Length * leg2Length);
+	double rightAngleError = fabs(acos(max(-1.0, min(1.0, cosAngle))) * 180 / CV_PI - 90);
+	if (rightAngleError > GROUP_RIGHT_ANGLE_ERROR_MAX) return false;
+
+	// Sides of the marks are aligned with the legs
+	double orientationError = max(getOrientationError(corner, leg1), max(getOrientationError(end1, leg1), getOrientationError(end2, leg2)));
+	if (orientationError > GROUP_ORIENTATION_ERROR_MAX) return false;
+
+	error = rightAngleError / GROUP_RIGHT_ANGLE_ERROR_MAX + (legRatio - 1) / (GROUP_LEG_RATIO_MAX - 1)
+			+ (moduleRatio - 1) / (GROUP_MODULE_SIZE_RATIO_MAX - 1) + orientationError / GROUP_ORIENTATION_ERROR_MAX;
+	return true;
+}
+
+/**
+ * Returns the continuity of the timing patterns of the triple. Modules of the timing
+ * patterns are sampled in the estimated grid and the alternating neighbours are counted.
+ *
+ * @param binarized Binarized image.
+ * @param corner Shape of the mark in the corner.
+ * @param end1 Shape of the mark at the end of the first leg.
+ * @param end2 Shape of the mark at the end of the second leg.
+ * @return Ratio of the alternating neighbours of the timing patterns (0 - 1).
+ */
+double QrMarkGrouper::getTimingContinuity(const Mat &binarized, const MarkShape &corner, const MarkShape &end1, const MarkShape &end2) {
+	Point2f leg1 = end1.center - corner.center;
+	Point2f leg2 = end2.center - corner.center;
+	double moduleSize = (corner.moduleSize + end1.moduleSize + end2.moduleSize) / 3;
+
+	// Centers of the finder patterns are 4 * version + 10 modules apart
+	double legModules = (norm(leg1) + norm(leg2)) / (2 * moduleSize);
+	int version = max(1, min(40, cvRound((legModules - 10) / 4)));
+	int legCount = 4 * version + 10;
+
+	Point2f step1 = leg1 * (1.0f / legCount);
+	Point2f step2 = leg2 * (1.0f / legCount);
+	int timingCount = legCount - 9;
+
+	return (getTimingAlternation(binarized, corner.center, step1, step2, timingCount)
+			+ getTimingAlternation(binarized, corner.center, step2, step1, timingCount)) / 2;
+}
+
+/**
+ * Returns the ratio of the alternating neighbours of the timing pattern along the leg.
+ *
+ * @param binarized Binarized image.
+ * @param origin Center of the mark in the corner.
+ * @param legStep Step of one module along the leg.
+ * @param inwardStep Step of one module towards the other leg.
+ * @param count Number of the modules of the timing pattern.
+ * @return Ratio of the alternating neighbours (0 - 1).
+ */
+double QrMarkGrouper::getTimingAlternation(const Mat &binarized, Point2f origin, Point2f legStep, Point2f inwardStep, int count) {
+	if (count < 2) return 0;
+
+	// Timing pattern starts 5 modules from the center of the finder pattern and lies 3 modules inwards
+	int alternating = 0;
+	bool previousDark = false;
+	for (int i = 0; i < count; i++) {
+		Point2f module = origin + legStep * (float)(5 + i) + inwardStep * 3.0f;
+		int x = cvRound(module.x);
+		int y = cvRound(module.y);
+		if ((x < 0) || (y < 0) || (x >= binarized.cols) || (y >= binarized.rows)) return 0;
+
+		bool dark = binarized.at<uchar>(y, x) < 128;
+		if ((i > 0) && (dark != previousDark)) alternating++;
+		previousDark = dark;
+	}
+
+	return (double)alternating / (count - 1);
+}
+
+} /* namespace barcodes */
@@ -0,0 +1,201 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrMarkGrouper.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines QrMarkGrouper class which groups the detected marks
+//             into the triples of the finder patterns of the QR codes.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrMarkGrouper.h
+ *
+ * @brief Defines QrMarkGrouper class which groups the detected marks
+ *        into the triples of the finder patterns of the QR codes.
+ * @author agent agent(at)local
+ */
+
+#ifndef QRMARKGROUPER_H_
+#define QRMARKGROUPER_H_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "../DetectedMarks.h"
+#include "../../common/ThresholdCache.h"
+
+namespace barcodes {
+using namespace std;
+using namespace cv;
+
+/**
+ * Groups the detected marks of the image with more QR codes. Triples of the marks
+ * are consistent if they form the right angle with the similar legs, the marks have
+ * the similar module size and their sides are aligned with the legs. Triples can be
+ * ranked also by the continuity of the timing patterns between the marks.
+ */
+class QrMarkGrouper {
+public:
+
+	/**
+	 * Triple of the marks which can be the finder patterns of one QR code.
+	 */
+	struct Triple {
+
+		/**
+		 * Index of the mark in the corner of the right angle.
+		 */
+		int corner;
+
+		/**
+		 * Indices of the marks at the ends of the legs.
+		 */
+		int ends[2];
+
+		/**
+		 * Geometric error of the triple, the lower the better.
+		 */
+		double error;
+
+		bool operator<(const Triple &rhs) const {
+			return error < rhs.error;
+		}
+	};
+
+	/**
+	 * Finds all consistent triples of the marks.
+	 *
+	 * @param detectedMarks Detected marks.
+	 * @param triples Output consistent triples sorted by the error, the best first.
+	 */
+	static void findTriples(const DetectedMarks &detectedMarks, vector<Triple> &triples);
+
+	/**
+	 * Groups the marks into the disjoint triples, better triples are taken first.
+	 *
+	 * @param detectedMarks Detected marks.
+	 * @param groups Output groups of three marks, the best first.
+	 */
+	static void groupMarks(const DetectedMarks &detectedMarks, vector<DetectedMarks> &groups);
+
+	/**
+	 * Finds all consistent triples of the marks and ranks them by the geometric error
+	 * and the continuity of the timing patterns between the marks.
+	 *
+	 * @param detectedMarks Detected marks.
+	 * @param thresholdCache Cache of the thresholds of the image, marks are sampled in their binarization.
+	 * @param triples Output consistent triples sorted by the total error, the best first.
+	 */
+	static void rankTriples(const DetectedMarks &detectedMarks, ThresholdCache &thresholdCache, vector<Triple> &triples);
+protected:
+
+	/**
+	 * Shape of the mark used for the consistency tests.
+	 */
+	struct MarkShape {
+
+		/**
+		 * Center of the mark.
+		 */
+		Point2f center;
+
+		/**
+		 * Estimated size of the module.
+		 */
+		float moduleSize;
+
+		/**
+		 * Angle of the sides of the mark (degrees).
+		 */
+		float angle;
+	};
+
+	/**
+	 * Maximal ratio of the module sizes of the marks in the triple.
+	 */
+	static const double GROUP_MODULE_SIZE_RATIO_MAX             =    1.5;
+
+	/**
+	 * Minimal and maximal length of the leg in the modules (versions 1 - 40 with the tolerance).
+	 */
+	static const double GROUP_LEG_MODULES_MIN                   =    10;
+	static const double GROUP_LEG_MODULES_MAX                   =    220;
+
+	/**
+	 * Maximal ratio of the lengths of the legs, the perspective can prolong one of them.
+	 */
+	static const double GROUP_LEG_RATIO_MAX                     =    1.6;
+
+	/**
+	 * Maximal deviation of the angle of the corner from the right angle (degrees).
+	 */
+	static const double GROUP_RIGHT_ANGLE_ERROR_MAX             =    30;
+
+	/**
+	 * Maximal deviation of the sides of the mark from the direction of the leg (degrees).
+	 */
+	static const double GROUP_ORIENTATION_ERROR_MAX             =    25;
+
+	/**
+	 * Weight of the discontinuity of the timing patterns in the total error. Random texture
+	 * alternates in the half of the modules, so the wrong triples get about the half of it.
+	 */
+	static const double GROUP_TIMING_ERROR_WEIGHT               =    4;
+
+	/**
+	 * Returns the shape of the mark.
+	 *
+	 * @param mark Detected mark.
+	 * @param shape Output shape of the mark.
+	 */
+	static void getShape(const DetectedMark &mark, MarkShape &shape);
+
+	/**
+	 * Returns the deviation of the sides of the mark from the direction.
+	 *
+	 * @param shape Shape of the mark.
+	 * @param direction Direction of the leg.
+	 * @return Deviation in the degrees (0 - 45).
+	 */
+	static double getOrientationError(const MarkShape &shape, const Point2f &direction);
+
+	/**
+	 * Tests whether the marks can be the finder patterns of one QR code and calculates the error.
+	 *
+	 * @param corner Shape of the mark in the corner.
+	 * @param end1 Shape of the mark at the end of the first leg.
+	 * @param end2 Shape of the mark at the end of the second leg.
+	 * @param error Output error of the triple.
+	 * @return True if the triple is consistent.
+	 */
+	static bool isConsistent(const MarkShape &corner, const MarkShape &end1, const MarkShape &end2, double &error);
+
+	/**
+	 * Returns the continuity of the timing patterns of the triple. Modules of the timing
+	 * patterns are sampled in the estimated grid and the alternating neighbours are counted.
+	 *
+	 * @param binarized Binarized image.
+	 * @param corner Shape of the mark in the corner.
+	 * @param end1 Shape of the mark at the end of the first leg.
+	 * @param end2 Shape of the mark at the end of the second leg.
+	 * @return Ratio of the alternating neighbours of the timing patterns (0 - 1).
+	 */
+	static double getTimingContinuity(const Mat &binarized, const MarkShape &corner, const MarkShape &end1, const MarkShape &end2);
+
+	/**
+	 * Returns the ratio of the alternating neighbours of the timing pattern along the leg.
+	 *
+	 * @param binarized Binarized image.
+	 * @param origin Center of the mark in the corner.
+	 * @param legStep Step of one module along the leg.
+	 * @param inwardStep Step of one module towards the other leg.
+	 * @param count Number of the modules of the timing pattern.
+	 * @return Ratio of the alternating neighbours (0 - 1).
+	 */
+	static double getTimingAlternation(const Mat &binarized, Point2f origin, Point2f legStep, Point2f inwardStep, int count);
+};
+
+} /* namespace barcodes */
+#endif /* QRMARKGROUPER_H_ */
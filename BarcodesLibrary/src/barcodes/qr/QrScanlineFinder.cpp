@@ -0,0 +1,491 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrScanlineFinder.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of QrScanlineFinder class which finds the finder
+//             patterns of the QR code by the run lengths of the scanlines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrScanlineFinder.cpp
+ *
+ * @brief Defines members of QrScanlineFinder class which finds the finder
+ *        patterns of the QR code by the run lengths of the scanlines.
+ * @author agent agent(at)local
+ */
+
+#include <cmath>
+#include <cstring>
+#include <cstdlib>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "../../debug.h"
+#include "../../common/Polygon2D.h"
+#include "QrScanlineFinder.h"
+
+#define DEBUG_TAG "QrScanlineFinder.cpp"
+
+namespace barcodes {
+
+/**
+ * Value of the flooded outer ring.
+ */
+static const int RING_COLOR = 128;
+
+/**
+ * Tests whether the point lies inside the image.
+ *
+ * @param image Tested image.
+ * @param point Tested point.
+ * @return True if the point lies inside the image.
+ */
+static inline bool isInside(const Mat &image, const Point &point) {
+	return (point.x >= 0) && (point.y >= 0) && (point.x < image.cols) && (point.y < image.rows);
+}
+
+/**
+ * Tests whether the pixel of the binarized image is dark.
+ *
+ * @param binarized Binarized image.
+ * @param point Point of the pixel.
+ * @return True if the pixel is dark.
+ */
+static inline bool isDark(const Mat &binarized, const Point &point) {
+	return binarized.at<uchar>(point.y, point.x) < 128;
+}
+
+/**
+ * Finds the finder patterns in the binarized image.
+ *
+ * @param binarized Binarized image (0 - dark, 255 - light).
+ * @param detectedMarks Found finder patterns, points are the corners of the outer ring.
+ * @param markMinSize The minimal size of the finder pattern.
+ */
+void QrScanlineFinder::find(const Mat &binarized, DetectedMarks &detectedMarks, int markMinSize) {
+	detectedMarks.clear();
+	if (binarized.data == NULL) return;
+
+	// Center run of the smallest pattern is crossed by the required number of the scanlines
+	int step = (3 * markMinSize) / (7 * CANDIDATE_MINIMAL_CONFIRMATIONS);
+	if (step < 1) step = 1;
+
+	vector<Candidate> candidates;
+	scanLines(binarized, false, step, candidates);
+	scanLines(binarized, true, step, candidates);
+
+	vector<Candidate> confirmed;
+	for (unsigned int i = 0; i < candidates.size(); i++) {
+		if ((candidates[i].count >= CANDIDATE_MINIMAL_CONFIRMATIONS) && (candidates[i].moduleSize * 7 >= markMinSize)) {
+			confirmed.push_back(candidates[i]);
+		}
+	}
+
+	DEBUG_PRINT(DEBUG_TAG, "candidates: %d, confirmed: %d", candidates.size(), confirmed.size());
+	if (confirmed.size() != FINDER_PATTERNS_COUNT) return;
+
+	// Match ratio is left for the template check of the detector
+	DetectedMark mark;
+	for (unsigned int i = 0; i < confirmed.size(); i++) {
+		if (!findRingCorners(binarized, confirmed[i], mark.points)) {
+			detectedMarks.clear();
+			return;
+		}
+
+		detectedMarks.push_back(mark);
+	}
+}
+
+/**
+ * Tests whether the runs have the ratio of the finder pattern 1:1:3:1:1.
+ *
+ * @param runs Lengths of the five runs (dark, light, dark, light, dark).
+ * @param maxVariance Maximal accepted variance of the run from the module size (in modules).
+ * @return True if the runs have the ratio of the finder pattern.
+ */
+bool QrScanlineFinder::isFinderRatio(const int runs[5], double maxVariance) {
+	int total = 0;
+	for (int i = 0; i < 5; i++) {
+		if (runs[i] == 0) return false;
+		total += runs[i];
+	}
+	if (total < 7) return false;
+
+	double moduleSize = total / 7.0;
+	double variance = moduleSize * maxVariance;
+
+	return (fabs(moduleSize - runs[0]) < variance) && (fabs(moduleSize - runs[1]) < variance)
+			&& (fabs(3 * moduleSize - runs[2]) < 3 * variance)
+			&& (fabs(moduleSize - runs[3]) < variance) && (fabs(moduleSize - runs[4]) < variance);
+}
+
+/**
+ * Tests cheaply whether the grayscale image can contain the finder patterns.
+ * Sparse rows are scanned for the runs in 1:1:3:1:1 ratio which are cross checked
+ * in the column, no binarization is needed.
+ *
+ * @param gray Grayscale image.
+ * @param markMinSize The minimal size of the finder pattern.
+ * @return True if some finder pattern is plausible or the image cannot be tested.
+ */
+bool QrScanlineFinder::isPresent(const Mat &gray, int markMinSize) {
+	if ((gray.data == NULL) || (gray.type() != CV_8UC1)) return true;
+
+	// Same density of the scanlines as in the finding, rows cross also the rotated patterns
+	int step = (3 * markMinSize) / (7 * CANDIDATE_MINIMAL_CONFIRMATIONS);
+	if (step < 1) step = 1;
+
+	vector<Point> hits;
+	int confirmed = 0;
+	for (int y = step / 2; y < gray.rows; y += step) {
+		hits.clear();
+		findPresenceHits(gray.ptr<uchar>(y), gray.cols, hits);
+
+		// Text and textures rarely have the ratio in both directions
+		for (unsigned int i = 0; i < hits.size(); i++) {
+			if (crossCheckPresence(gray, Point(hits[i].x, y), hits[i].y)) confirmed++;
+			if (confirmed >= PRESENCE_MINIMAL_HITS) return true;
+		}
+	}
+
+	DEBUG_PRINT(DEBUG_TAG, "presence confirmed: %d", confirmed);
+	return false;
+}
+
+/**
+ * Finds the runs in the finder pattern ratio on the grayscale line. The line is split
+ * into the runs with the hysteresis, the run ends when the intensity leaves the extreme
+ * of the run by the minimal contrast, so the gradual illumination changes are ignored.
+ *
+ * @param line Pixels of the line.
+ * @param length Length of the line.
+ * @param hits Output hits, x is the center of the middle run and y is the length of all five runs.
+ */
+void QrScanlineFinder::findPresenceHits(const uchar *line, int length, vector<Point> &hits) {
+	int runs[5] = {0, 0, 0, 0, 0};
+	int runStart = 0;
+	int extreme = line[0];
+	bool dark = false;
+
+	for (int x = 1; x < length; x++) {
+		int value = line[x];
+
+		if (dark ? (value < extreme) : (value > extreme)) {
+			extreme = value;
+			continue;
+		}
+
+		if (dark ? (value <= extreme + PRESENCE_MINIMAL_CONTRAST) : (value >= extreme - PRESENCE_MINIMAL_CONTRAST)) {
+			continue;
+		}
+
+		// Run has ended, the last five runs are shifted
+		runs[0] = runs[1]; runs[1] = runs[2]; runs[2] = runs[3]; runs[3] = runs[4];
+		runs[4] = x - runStart;
+
+		// Dark run has ended, the last runs are dark, light, dark, light, dark
+		if (dark && isFinderRatio(runs, FINDER_DIAGONAL_RATIO_MAX_VARIANCE)) {
+			int center = x - runs[4] - runs[3] - runs[2] / 2;
+			hits.push_back(Point(center, runs[0] + runs[1] + runs[2] + runs[3] + runs[4]));
+		}
+
+		runStart = x;
+		extreme = value;
+		dark = !dark;
+	}
+}
+
+/**
+ * Cross checks the hit of the row in the column through its center.
+ *
+ * @param gray Grayscale image.
+ * @param center Center of the hit.
+ * @param size Length of all five runs of the hit.
+ * @return True if the column has the runs of the same size and center.
+ */
+bool QrScanlineFinder::crossCheckPresence(const Mat &gray, Point center, int size) {
+	int top = max(center.y - size, 0);
+	int bottom = min(center.y + size + 1, gray.rows);
+
+	vector<uchar> column(bottom - top);
+	for (int y = top; y < bottom; y++) {
+		column[y - top] = gray.at<uchar>(y, center.x);
+	}
+
+	vector<Point> hits;
+	findPresenceHits(&column[0], column.size(), hits);
+
+	// Rotated pattern is larger in the column, at most by sqrt(2)
+	double moduleSize = size / 7.0;
+	for (unsigned int i = 0; i < hits.size(); i++) {
+		if ((abs(hits[i].x + top - center.y) <= 1.5 * moduleSize) && (hits[i].y >= size * 0.6) && (hits[i].y <= size * 1.6)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/**
+ * Scans the lines of the image (rows or columns) and adds the confirmed hits into the candidates.
+ *
+ * @param binarized Binarized image.
+ * @param vertical True for scanning of the columns, false for the rows.
+ * @param step Step between the scanned lines.
+ * @param candidates Finder pattern candidates.
+ */
+void QrScanlineFinder::scanLines(const Mat &binarized, bool vertical, int step, vector<Candidate> &candidates) {
+	int lines = (vertical)? binarized.cols : binarized.rows;
+	int length = (vertical)? binarized.rows : binarized.cols;
+	int stride = (vertical)? (int)binarized.step : 1;
+	Point direction = (vertical)? Point(0, 1) : Point(1, 0);
+	vector<int> runs;
+	vector<int> starts;
+
+	for (int line = step / 2; line < lines; line += step) {
+		const uchar *pixels = (vertical)? binarized.data + line : binarized.ptr<uchar>(line);
+
+		// Run lengths of the line
+		runs.clear();
+		starts.clear();
+		int runStart = 0;
+		for (int i = 1; i <= length; i++) {
+			if ((i == length) || ((pixels[i * stride] < 128) != (pixels[(i - 1) * stride] < 128))) {
+				runs.push_back(i - runStart);
+				starts.push_back(runStart);
+				runStart = i;
+			}
+		}
+
+		// Every dark run can start the pattern
+		for (unsigned int i = (pixels[0] < 128)? 0 : 1; i + 4 < runs.size(); i += 2) {
+			if (!isFinderRatio(&runs[i])) continue;
+
+			float position = starts[i + 2] + (runs[i + 2] - 1) / 2.0f;
+			Point2f center = (vertical)? Point2f(line, position) : Point2f(position, line);
+			crossCheck(binarized, center, direction, &runs[i], candidates);
+		}
+	}
+}
+
+/**
+ * Counts the runs of the finder pattern in the specified direction around the center.
+ *
+ * @param binarized Binarized image.
+ * @param center Point inside the center dark run.
+ * @param direction Direction of the scanning (one step).
+ * @param maxRun Maximal length of the outer runs.
+ * @param runs Output lengths of the five runs.
+ * @param centerOffset Output offset of the center of the middle run from the center point (in steps).
+ * @return True if all five runs have been counted.
+ */
+bool QrScanlineFinder::countRuns(const Mat &binarized, Point center, Point direction, int maxRun, int runs[5], float &centerOffset) {
+	memset(runs, 0, 5 * sizeof(int));
+	if (!isInside(binarized, center) || !isDark(binarized, center)) return false;
+
+	// Backward runs from the center
+	int backward = 0;
+	Point point = center;
+	while (isInside(binarized, point) && isDark(binarized, point)) {
+		backward++;
+		point -= direction;
+	}
+	while (isInside(binarized, point) && !isDark(binarized, point) && (runs[1] <= maxRun)) {
+		runs[1]++;
+		point -= direction;
+	}
+	if (!isInside(binarized, point) || (runs[1] > maxRun)) return false;
+	while (isInside(binarized, point) && isDark(binarized, point) && (runs[0] <= maxRun)) {
+		runs[0]++;
+		point -= direction;
+	}
+	if (runs[0] > maxRun) return false;
+
+	// Forward runs from the center
+	int forward = 0;
+	point = center + direction;
+	while (isInside(binarized, point) && isDark(binarized, point)) {
+		forward++;
+		point += direction;
+	}
+	while (isInside(binarized, point) && !isDark(binarized, point) && (runs[3] <= maxRun)) {
+		runs[3]++;
+		point += direction;
+	}
+	if (!isInside(binarized, point) || (runs[3] > maxRun)) return false;
+	while (isInside(binarized, point) && isDark(binarized, point) && (runs[4] <= maxRun)) {
+		runs[4]++;
+		point += direction;
+	}
+	if (runs[4] > maxRun) return false;
+
+	runs[2] = backward + forward;
+	centerOffset = (forward - backward + 1) / 2.0f;
+	return true;
+}
+
+/**
+ * Cross checks the hit of the scanline and adds it into the candidates.
+ *
+ * @param binarized Binarized image.
+ * @param center Center of the middle run of the hit.
+ * @param direction Direction of the scanline.
+ * @param runs Runs of the hit.
+ * @param candidates Finder pattern candidates.
+ * @return True if the hit has been confirmed.
+ */
+bool QrScanlineFinder::crossCheck(const Mat &binarized, Point2f center, Point direction, const int runs[5], vector<Candidate> &candidates) {
+	Point perpendicular(direction.y, direction.x);
+	int crossRuns[5];
+	int lineRuns[5];
+	int diagonalRuns[5];
+	float offset;
+
+	int total = runs[0] + runs[1] + runs[2] + runs[3] + runs[4];
+	int maxRun = runs[2];
+
+	// Perpendicular check moves the center into the middle of the pattern
+	Point start(cvRound(center.x), cvRound(center.y));
+	if (!countRuns(binarized, start, perpendicular, maxRun, crossRuns, offset)
+			|| !isFinderRatio(crossRuns)) return false;
+
+	int crossTotal = crossRuns[0] + crossRuns[1] + crossRuns[2] + crossRuns[3] + crossRuns[4];
+	if (5 * abs(crossTotal - total) >= 2 * total) return false;
+	if (perpendicular.x) center.x = start.x + offset;
+	if (perpendicular.y) center.y = start.y + offset;
+
+	// Check of the scanline direction again from the moved center
+	start = Point(cvRound(center.x), cvRound(center.y));
+	if (!countRuns(binarized, start, direction, maxRun, lineRuns, offset)
+			|| !isFinderRatio(lineRuns)) return false;
+
+	if (direction.x) center.x = start.x + offset;
+	if (direction.y) center.y = start.y + offset;
+
+	// Diagonal check rejects the crossings of the perpendicular lines
+	if (!countRuns(binarized, Point(cvRound(center.x), cvRound(center.y)), Point(1, 1), maxRun, diagonalRuns, offset)
+			|| !isFinderRatio(diagonalRuns, FINDER_DIAGONAL_RATIO_MAX_VARIANCE)) return false;
+
+	int lineTotal = lineRuns[0] + lineRuns[1] + lineRuns[2] + lineRuns[3] + lineRuns[4];
+	float moduleSize = (crossTotal + lineTotal) / 14.0f;
+	float deviation = (getDeviation(crossRuns) + getDeviation(lineRuns)) / 2.0f;
+
+	addCandidate(candidates, center, moduleSize, deviation);
+	return true;
+}
+
+/**
+ * Calculates average deviation of the runs from the ideal ratio (in modules).
+ *
+ * @param runs Lengths of the five runs.
+ * @return Average deviation of the runs.
+ */
+float QrScanlineFinder::getDeviation(const int runs[5]) {
+	static const int RATIO[] = {1, 1, 3, 1, 1};
+	float moduleSize = (runs[0] + runs[1] + runs[2] + runs[3] + runs[4]) / 7.0f;
+
+	float deviation = 0;
+	for (int i = 0; i < 5; i++) {
+		deviation += fabs(runs[i] - RATIO[i] * moduleSize);
+	}
+	return deviation / (5 * moduleSize);
+}
+
+/**
+ * Adds the hit into the candidates, hits of the same pattern are merged.
+ *
+ * @param candidates Finder pattern candidates.
+ * @param center Center of the hit.
+ * @param moduleSize Estimated size of the module.
+ * @param deviation Deviation of the runs of the hit.
+ */
+void QrScanlineFinder::addCandidate(vector<Candidate> &candidates, Point2f center, float moduleSize, float deviation) {
+	vector<Candidate>::iterator iter;
+
+	for (iter = candidates.begin(); iter != candidates.end(); iter++) {
+		if ((fabs(iter->center.x - center.x) > iter->moduleSize) || (fabs(iter->center.y - center.y) > iter->moduleSize)) continue;
+
+		float sizeDifference = fabs(iter->moduleSize - moduleSize);
+		if ((sizeDifference > 1) && (sizeDifference > iter->moduleSize)) continue;
+
+		// Averaging of the hits of the same pattern
+		float count = iter->count;
+		iter->center.x = (iter->center.x * count + center.x) / (count + 1);
+		iter->center.y = (iter->center.y * count + center.y) / (count + 1);
+		iter->moduleSize = (iter->moduleSize * count + moduleSize) / (count + 1);
+		iter->deviation = (iter->deviation * count + deviation) / (count + 1);
+		iter->count++;
+		return;
+	}
+
+	Candidate candidate;
+	candidate.center = center;
+	candidate.moduleSize = moduleSize;
+	candidate.deviation = deviation;
+	candidate.count = 1;
+	candidates.push_back(candidate);
+}
+
+/**
+ * Finds the corners of the outer dark ring of the finder pattern.
+ *
+ * @param binarized Binarized image.
+ * @param candidate Confirmed finder pattern candidate.
+ * @param corners Output corners of the outer ring.
+ * @return True if the corners have been found.
+ */
+bool QrScanlineFinder::findRingCorners(const Mat &binarized, const Candidate &candidate, vector<Point> &corners) {
+	corners.clear();
+
+	// Flooding the copy of the pattern surroundings only
+	float radius = candidate.moduleSize * FINDER_SURROUNDINGS_RADIUS;
+	Rect roi(cvFloor(candidate.center.x - radius), cvFloor(candidate.center.y - radius), cvCeil(2 * radius) + 1, cvCeil(2 * radius) + 1);
+	roi &= Rect(0, 0, binarized.cols, binarized.rows);
+	if ((roi.width == 0) || (roi.height == 0)) return false;
+
+	Mat ring = binarized(roi).clone();
+
+	// Seed of the outer ring lies behind the center run and the light ring
+	Point seed(cvRound(candidate.center.x) - roi.x, cvRound(candidate.center.y) - roi.y);
+	if (!isInside(ring, seed)) return false;
+	while ((seed.x >= 0) && isDark(ring, seed)) seed.x--;
+	while ((seed.x >= 0) && !isDark(ring, seed)) seed.x--;
+	if (seed.x < 0) return false;
+
+	Rect ringRect;
+	int ringArea = floodFill(ring, seed, Scalar(RING_COLOR), &ringRect, Scalar(), Scalar(), 4);
+
+	// Ring which reaches the border of the surroundings is merged with other dark area
+	if ((ringRect.x == 0) || (ringRect.y == 0) || (ringRect.x + ringRect.width >= ring.cols)
+			|| (ringRect.y + ringRect.height >= ring.rows)) return false;
+
+	vector<vector<Point> > contours;
+	Mat ringMask = (ring == RING_COLOR);
+	findContours(ringMask, contours, CV_RETR_EXTERNAL, CV_CHAIN_APPROX_SIMPLE);
+	if (contours.empty()) return false;
+
+	unsigned int largest = 0;
+	for (unsigned int i = 1; i < contours.size(); i++) {
+		if (contours[i].size() > contours[largest].size()) largest = i;
+	}
+
+	vector<Point> hull;
+	convexHull(Mat(contours[largest]), hull);
+	double hullArea = contourArea(Mat(hull));
+	if (hullArea <= 0) return false;
+
+	double ringHullRatio = ringArea / hullArea;
+	if ((ringHullRatio < FINDER_RING_HULL_RATIO_MIN) || (ringHullRatio > FINDER_RING_HULL_RATIO_MAX)) return false;
+
+	int pointSize = ceil((ringRect.width + ringRect.height) / 7.0);
+	Polygon2D::findCorners(hull, 4, pointSize, corners, FINDER_MINIMAL_CORNER_ANGLE, FINDER_OPTIMAL_CORNER_ANGLE);
+	if (corners.size() != 4) return false;
+
+	convexHull(corners, corners);
+	Polygon2D::offset(corners, Point(roi.x, roi.y));
+	return true;
+}
+
+} /* namespace barcodes */
@@ -0,0 +1,238 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrScanlineFinder.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines QrScanlineFinder class which finds the finder patterns
+//             of the QR code by the run lengths of the scanlines.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrScanlineFinder.h
+ *
+ * @brief Defines QrScanlineFinder class which finds the finder patterns
+ *        of the QR code by the run lengths of the scanlines.
+ * @author agent agent(at)local
+ */
+
+#ifndef QRSCANLINEFINDER_H_
+#define QRSCANLINEFINDER_H_
+
+#include <vector>
+#include <opencv2/core/core.hpp>
+
+#include "../DetectedMarks.h"
+
+namespace barcodes {
+using namespace std;
+using namespace cv;
+
+/**
+ * Finds the finder patterns in the binarized image by scanning the rows and
+ * columns for the dark/light runs in 1:1:3:1:1 ratio. Every hit is cross
+ * checked vertically, horizontally and diagonally and the confirmed centers
+ * are converted into the quads of the outer dark ring of the pattern.
+ */
+class QrScanlineFinder {
+public:
+
+	/**
+	 * Finds the finder patterns in the binarized image.
+	 *
+	 * @param binarized Binarized image (0 - dark, 255 - light).
+	 * @param detectedMarks Found finder patterns, points are the corners of the outer ring.
+	 * @param markMinSize The minimal size of the finder pattern.
+	 */
+	static void find(const Mat &binarized, DetectedMarks &detectedMarks, int markMinSize);
+
+	/**
+	 * Tests whether the runs have the ratio of the finder pattern 1:1:3:1:1.
+	 *
+	 * @param runs Lengths of the five runs (dark, light, dark, light, dark).
+	 * @param maxVariance Maximal accepted variance of the run from the module size (in modules).
+	 * @return True if the runs have the ratio of the finder pattern.
+	 */
+	static bool isFinderRatio(const int runs[5], double maxVariance = FINDER_RATIO_MAX_VARIANCE);
+
+	/**
+	 * Tests cheaply whether the grayscale image can contain the finder patterns.
+	 * Sparse rows are scanned for the runs in 1:1:3:1:1 ratio which are cross checked
+	 * in the column, no binarization is needed.
+	 *
+	 * @param gray Grayscale image.
+	 * @param markMinSize The minimal size of the finder pattern.
+	 * @return True if some finder pattern is plausible or the image cannot be tested.
+	 */
+	static bool isPresent(const Mat &gray, int markMinSize);
+protected:
+
+	/**
+	 * Finder pattern candidate which is merged from the hits of the scanlines.
+	 */
+	struct Candidate {
+
+		/**
+		 * Center of the finder pattern.
+		 */
+		Point2f center;
+
+		/**
+		 * Estimated size of the module.
+		 */
+		float moduleSize;
+
+		/**
+		 * Number of the scanlines which have confirmed the candidate.
+		 */
+		int count;
+
+		/**
+		 * Average deviation of the runs from the ideal ratio (in modules).
+		 */
+		float deviation;
+	};
+
+	/**
+	 * Maximal accepted variance of the run from the module size (in modules).
+	 */
+	static const double FINDER_RATIO_MAX_VARIANCE               =    0.5;
+
+	/**
+	 * Maximal accepted variance of the diagonal run from the module size (in modules).
+	 * Diagonal runs are distorted by the rotation, so the check is more lenient.
+	 */
+	static const double FINDER_DIAGONAL_RATIO_MAX_VARIANCE      =    0.75;
+
+	/**
+	 * Minimal number of the scanlines which have to confirm the candidate.
+	 */
+	static const int CANDIDATE_MINIMAL_CONFIRMATIONS            =    2;
+
+	/**
+	 * Number of the finder patterns of the QR code. Other results are
+	 * left for the contour detection which is able to resolve them.
+	 */
+	static const int FINDER_PATTERNS_COUNT                      =    3;
+
+	/**
+	 * Radius of the finder pattern surroundings in which is the outer ring
+	 * flooded (in modules). It covers the whole pattern rotated by 45 degrees.
+	 */
+	static const double FINDER_SURROUNDINGS_RADIUS              =    5.5;
+
+	/**
+	 * Minimal and maximal ratio of the outer ring area and its hull area (reference 24 / 49).
+	 */
+	static const double FINDER_RING_HULL_RATIO_MIN              =    0.3;
+	static const double FINDER_RING_HULL_RATIO_MAX              =    0.7;
+
+	/**
+	 * The minimal angle accepted for a corner.
+	 */
+	static const double FINDER_MINIMAL_CORNER_ANGLE             =    35; // degrees
+
+	/**
+	 * The optimal angle accepted for a corner.
+	 */
+	static const double FINDER_OPTIMAL_CORNER_ANGLE             =    90; // degrees
+
+	/**
+	 * Minimal change of the intensity between the dark and light run of the presence test.
+	 */
+	static const int PRESENCE_MINIMAL_CONTRAST                  =    24;
+
+	/**
+	 * Minimal number of the cross checked runs in the finder pattern ratio which pass
+	 * the presence test. One finder pattern of the three can be damaged.
+	 */
+	static const int PRESENCE_MINIMAL_HITS                      =    2;
+
+	/**
+	 * Scans the lines of the image (rows or columns) and adds the confirmed hits into the candidates.
+	 *
+	 * @param binarized Binarized image.
+	 * @param vertical True for scanning of the columns, false for the rows.
+	 * @param step Step between the scanned lines.
+	 * @param candidates Finder pattern candidates.
+	 */
+	static void scanLines(const Mat &binarized, bool vertical, int step, vector<Candidate> &candidates);
+
+	/**
+	 * Counts the runs of the finder pattern in the specified direction around the center.
+	 *
+	 * @param binarized Binarized image.
+	 * @param center Point inside the center dark run.
+	 * @param direction Direction of the scanning (one step).
+	 * @param maxRun Maximal length of the outer runs.
+	 * @param runs Output lengths of the five runs.
+	 * @param centerOffset Output offset of the center of the middle run from the center point (in steps).
+	 * @return True if all five runs have been counted.
+	 */
+	static bool countRuns(const Mat &binarized, Point center, Point direction, int maxRun, int runs[5], float &centerOffset);
+
+	/**
+	 * Cross checks the hit of the scanline and adds it into the candidates.
+	 *
+	 * @param binarized Binarized image.
+	 * @param center Center of the middle run of the hit.
+	 * @param direction Direction of the scanline.
+	 * @param runs Runs of the hit.
+	 * @param candidates Finder pattern candidates.
+	 * @return True if the hit has been confirmed.
+	 */
+	static bool crossCheck(const Mat &binarized, Point2f center, Point direction, const int runs[5], vector<Candidate> &candidates);
+
+	/**
+	 * Calculates average deviation of the runs from the ideal ratio (in modules).
+	 *
+	 * @param runs Lengths of the five runs.
+	 * @return Average deviation of the runs.
+	 */
+	static float getDeviation(const int runs[5]);
+
+	/**
+	 * Adds the hit into the candidates, hits of the same pattern are merged.
+	 *
+	 * @param candidates Finder pattern candidates.
+	 * @param center Center of the hit.
+	 * @param moduleSize Estimated size of the module.
+	 * @param deviation Deviation of the runs of the hit.
+	 */
+	static void addCandidate(vector<Candidate> &candidates, Point2f center, float moduleSize, float deviation);
+
+	/**
+	 * Finds the corners of the outer dark ring of the finder pattern.
+	 *
+	 * @param binarized Binarized image.
+	 * @param candidate Confirmed finder pattern candidate.
+	 * @param corners Output corners of the outer ring.
+	 * @return True if the corners have been found.
+	 */
+	static bool findRingCorners(const Mat &binarized, const Candidate &candidate, vector<Point> &corners);
+
+	/**
+	 * Finds the runs in the finder pattern ratio on the grayscale line. The line is split
+	 * into the runs with the hysteresis, the run ends when the intensity leaves the extreme
+	 * of the run by the minimal contrast, so the gradual illumination changes are ignored.
+	 *
+	 * @param line Pixels of the line.
+	 * @param length Length of the line.
+	 * @param hits Output hits, x is the center of the middle run and y is the length of all five runs.
+	 */
+	static void findPresenceHits(const uchar *line, int length, vector<Point> &hits);
+
+	/**
+	 * Cross checks the hit of the row in the column through its center.
+	 *
+	 * @param gray Grayscale image.
+	 * @param center Center of the hit.
+	 * @param size Length of all five runs of the hit.
+	 * @return True if the column has the runs of the same size and center.
+	 */
+	static bool crossCheckPresence(const Mat &gray, Point center, int size);
+};
+
+} /* namespace barcodes */
+#endif /* QRSCANLINEFINDER_H_ */
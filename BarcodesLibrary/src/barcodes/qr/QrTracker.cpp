@@ -0,0 +1,234 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrTracker.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of QrTracker class which seeds the detection
+//             of the QR code in the video frames from the previous frame.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrTracker.cpp
+ *
+ * @brief Defines members of QrTracker class which seeds the detection
+ *        of the QR code in the video frames from the previous frame.
+ * @author agent agent(at)local
+ */
+
+#include <cmath>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "../../common/Polygon2D.h"
+#include "../../common/ThresholdCache.h"
+#include "QrTracker.h"
+#include "QrDecoder.h"
+
+namespace barcodes {
+
+/**
+ * Margin of the tracking window as a ratio of the size of the last marks.
+ */
+const double QrTracker::TRACKING_WINDOW_MARGIN_RATIO = 0.5;
+
+QrTracker::QrTracker() : moduleSize(0) {
+}
+
+/**
+ * Detects QR code on the frame and returns localization marks.
+ *
+ * @param image Frame with the QR code.
+ * @param detectedMarks Recognized localization marks.
+ * @param flags Flags used for the full-frame detection.
+ */
+void QrTracker::detect(Image &image, DetectedMarks &detectedMarks, int flags) {
+	if (isTracking()) {
+		Rect window = getPredictedWindow(Size(image.cols, image.rows));
+		Image windowImage(((Mat &)image)(window), image.getColorFormat());
+		ThresholdCache windowCache(windowImage, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
+		detectInWindow(windowImage, windowCache, detectedMarks, flags);
+
+		if (detectedMarks.size() >= 3) {
+			offsetMarks(detectedMarks, window.tl());
+			update(detectedMarks);
+			return;
+		}
+	}
+
+	// Tracking has been lost, whole frame is searched
+	ThresholdCache thresholdCache(image, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
+	QrDetector::getInstance()->detect(image, detectedMarks, thresholdCache, context.detectContext, Deadline(), flags);
+	update(detectedMarks);
+}
+
+/**
+ * Decodes QR code on the frame and returns decoded data segments.
+ * Tracking continues only if the QR code has been decoded.
+ *
+ * @param image Frame with the QR code.
+ * @param dataSegments Result decoded data segments.
+ * @param flags Flags used for the full-frame detection and decoding.
+ */
+void QrTracker::decode(Image &image, DataSegments &dataSegments, int flags) {
+	const QrDecoder *decoder = QrDecoder::getInstance();
+	DetectedMarks detectedMarks;
+	Deadline deadline;
+
+	if (isTracking()) {
+		Rect window = getPredictedWindow(Size(image.cols, image.rows));
+		Image windowImage(((Mat &)image)(window), image.getColorFormat());
+		ThresholdCache windowCache(windowImage, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
+		detectInWindow(windowImage, windowCache, detectedMarks, flags);
+
+		dataSegments.clear();
+		dataSegments.flags = 0;
+		decoder->decodeMarks(windowImage, dataSegments, detectedMarks, windowCache, context, deadline, flags);
+
+		if (dataSegments.size() > 0) {
+			offsetMarks(detectedMarks, window.tl());
+			Polygon2D::offset(context.corners, window.tl());
+			update(detectedMarks);
+			return;
+		}
+	}
+
+	// Tracking has been lost, whole frame is searched
+	ThresholdCache thresholdCache(image, flags & QrDetector::FLAG_PARALLEL_BINARIZATION);
+	QrDetector::getInstance()->detect(image, detectedMarks, thresholdCache, context.detectContext, deadline, flags);
+
+	dataSegments.clear();
+	dataSegments.flags = 0;
+	decoder->decodeMarks(image, dataSegments, detectedMarks, thresholdCache, context, deadline, flags);
+
+	if (dataSegments.size() > 0) {
+		update(detectedMarks);
+	} else {
+		reset();
+	}
+}
+
+/**
+ * Returns whether the QR code is tracked from the previous frame.
+ *
+ * @return True if the QR code is tracked.
+ */
+bool QrTracker::isTracking() const {
+	return trackedMarks.size() >= 3;
+}
+
+/**
+ * Returns the marks of the last frame.
+ *
+ * @return Marks of the last frame.
+ */
+const DetectedMarks &QrTracker::getTrackedMarks() const {
+	return trackedMarks;
+}
+
+/**
+ * Returns the context of the last decoding.
+ *
+ * @return Context of the last decoding.
+ */
+const DecodeContext &QrTracker::getContext() const {
+	return context;
+}
+
+/**
+ * Loses the tracking, the next frame is searched in full.
+ */
+void QrTracker::reset() {
+	trackedMarks.clear();
+	moduleSize = 0;
+}
+
+/**
+ * Returns the window where the marks are expected in the next frame.
+ *
+ * @param imageSize Size of the frame.
+ * @return Window of the frame.
+ */
+Rect QrTracker::getPredictedWindow(Size imageSize) const {
+	vector<Point> points;
+	for (unsigned int i = 0; i < trackedMarks.size(); i++) {
+		points.insert(points.end(), trackedMarks[i].points.begin(), trackedMarks[i].points.end());
+	}
+
+	Rect bounds = boundingRect(Mat(points));
+	int margin = max(bounds.width, bounds.height) * TRACKING_WINDOW_MARGIN_RATIO;
+	Rect window(bounds.x - margin, bounds.y - margin, bounds.width + 2 * margin, bounds.height + 2 * margin);
+	window &= Rect(0, 0, imageSize.width, imageSize.height);
+
+	return window;
+}
+
+/**
+ * Returns the block size of the adaptive threshold matching the module size.
+ *
+ * @return Block size of the adaptive threshold (odd number).
+ */
+int QrTracker::getTrackingBlockSize() const {
+	int blockSize = cvRound(moduleSize * TRACKING_BLOCK_SIZE_PER_MODULE) | 1;
+	return max(blockSize, 3);
+}
+
+/**
+ * Detects the marks only inside the predicted window.
+ *
+ * @param windowImage Image of the window.
+ * @param windowCache Cache of the thresholds of the window.
+ * @param detectedMarks Recognized localization marks in the window coordinates.
+ * @param flags Match tolerance/Scanline finder flags.
+ */
+void QrTracker::detectInWindow(Image &windowImage, ThresholdCache &windowCache, DetectedMarks &detectedMarks, int flags) {
+	const QrDetector *detector = QrDetector::getInstance();
+	detector->detectWithBlockSize(windowImage, detectedMarks, windowCache, context.detectContext, getTrackingBlockSize(), flags);
+
+	// Module size has changed too much, distances of the window are tried without repairs
+	if (detectedMarks.size() < 3) {
+		detector->detect(windowImage, detectedMarks, windowCache, context.detectContext, Deadline(),
+				flags & ~QrDetector::REPAIR_FLAGS);
+	}
+}
+
+/**
+ * Offsets the points and the refined points of the marks from the window to the frame coordinates.
+ *
+ * @param detectedMarks Marks in the window coordinates.
+ * @param offset Top left corner of the window.
+ */
+void QrTracker::offsetMarks(DetectedMarks &detectedMarks, Point offset) {
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		Polygon2D::offset(detectedMarks[i].points, offset);
+
+		vector<Point2f> &refinedPoints = detectedMarks[i].refinedPoints;
+		for (unsigned int j = 0; j < refinedPoints.size(); j++) {
+			refinedPoints[j].x += offset.x;
+			refinedPoints[j].y += offset.y;
+		}
+	}
+}
+
+/**
+ * Remembers the marks and estimates the module size, empty marks lose the tracking.
+ *
+ * @param detectedMarks Marks of the current frame.
+ */
+void QrTracker::update(const DetectedMarks &detectedMarks) {
+	if (detectedMarks.size() < 3) {
+		reset();
+		return;
+	}
+
+	// Finder pattern is 7 modules wide
+	double sumModuleSize = 0;
+	for (unsigned int i = 0; i < detectedMarks.size(); i++) {
+		sumModuleSize += sqrt(fabs(contourArea(Mat(detectedMarks[i].points)))) / 7.0;
+	}
+
+	trackedMarks = detectedMarks;
+	moduleSize = sumModuleSize / detectedMarks.size();
+}
+
+} /* namespace barcodes */
@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       QrTracker.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines QrTracker class which seeds the detection of the QR code
+//             in the video frames from the previous frame.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file QrTracker.h
+ *
+ * @brief Defines QrTracker class which seeds the detection of the QR code
+ *        in the video frames from the previous frame.
+ * @author agent agent(at)local
+ */
+
+#ifndef QRTRACKER_H_
+#define QRTRACKER_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "../../common/Image.h"
+#include "../DataSegments.h"
+#include "../DecodeContext.h"
+#include "../DetectedMarks.h"
+#include "QrDetector.h"
+
+namespace barcodes {
+using namespace cv;
+
+/**
+ * Tracker of the QR code in the consecutive video frames. It remembers the marks
+ * and the module size of the last frame. Next frame is searched only in the window
+ * around the last marks with the block size of the adaptive threshold matching
+ * the module size. Full-frame detection is used only when the tracking is lost.
+ * Tracker is not thread safe, every video stream has to use its own tracker.
+ */
+class QrTracker {
+public:
+	QrTracker();
+	virtual ~QrTracker() {}
+
+	/**
+	 * Detects QR code on the frame and returns localization marks.
+	 *
+	 * @param image Frame with the QR code.
+	 * @param detectedMarks Recognized localization marks.
+	 * @param flags Flags used for the full-frame detection.
+	 */
+	void detect(Image &image, DetectedMarks &detectedMarks, int flags = QrDetector::FLAG_ADAPT_THRESH |
+			QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL |
+			QrDetector::FLAG_SCANLINE_FINDER);
+
+	/**
+	 * Decodes QR code on the frame and returns decoded data segments.
+	 * Tracking continues only if the QR code has been decoded.
+	 *
+	 * @param image Frame with the QR code.
+	 * @param dataSegments Result decoded data segments.
+	 * @param flags Flags used for the full-frame detection and decoding.
+	 */
+	void decode(Image &image, DataSegments &dataSegments, int flags = QrDetector::FLAG_ADAPT_THRESH |
+			QrDetector::REPAIR_FLAGS | QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL |
+			QrDetector::FLAG_SCANLINE_FINDER);
+
+	/**
+	 * Returns whether the QR code is tracked from the previous frame.
+	 *
+	 * @return True if the QR code is tracked.
+	 */
+	bool isTracking() const;
+
+	/**
+	 * Returns the marks of the last frame.
+	 *
+	 * @return Marks of the last frame.
+	 */
+	const DetectedMarks &getTrackedMarks() const;
+
+	/**
+	 * Returns the context of the last decoding.
+	 *
+	 * @return Context of the last decoding.
+	 */
+	const DecodeContext &getContext() const;
+
+	/**
+	 * Loses the tracking, the next frame is searched in full.
+	 */
+	void reset();
+protected:
+
+	/**
+	 * Margin of the tracking window as a ratio of the size of the last marks.
+	 */
+	static const double TRACKING_WINDOW_MARGIN_RATIO;
+
+	/**
+	 * Block size of the adaptive threshold in the modules.
+	 */
+	static const int TRACKING_BLOCK_SIZE_PER_MODULE = 7;
+
+	DetectedMarks trackedMarks; /**< Marks of the last frame */
+	double moduleSize;			/**< Estimated size of the module in the last frame */
+	DecodeContext context;		/**< Context of the detection and decoding */
+
+	/**
+	 * Returns the window where the marks are expected in the next frame.
+	 *
+	 * @param imageSize Size of the frame.
+	 * @return Window of the frame.
+	 */
+	Rect getPredictedWindow(Size imageSize) const;
+
+	/**
+	 * Returns the block size of the adaptive threshold matching the module size.
+	 *
+	 * @return Block size of the adaptive threshold (odd number).
+	 */
+	int getTrackingBlockSize() const;
+
+	/**
+	 * Detects the marks only inside the predicted window.
+	 *
+	 * @param windowImage Image of the window.
+	 * @param windowCache Cache of the thresholds of the window.
+	 * @param detectedMarks Recognized localization marks in the window coordinates.
+	 * @param flags Match tolerance/Scanline finder flags.
+	 */
+	void detectInWindow(Image &windowImage, ThresholdCache &windowCache, DetectedMarks &detectedMarks, int flags);
+
+	/**
+	 * Offsets the points and the refined points of the marks from the window to the frame coordinates.
+	 *
+	 * @param detectedMarks Marks in the window coordinates.
+	 * @param offset Top left corner of the window.
+	 */
+	static void offsetMarks(DetectedMarks &detectedMarks, Point offset);
+
+	/**
+	 * Remembers the marks and estimates the module size, empty marks lose the tracking.
+	 *
+	 * @param detectedMarks Marks of the current frame.
+	 */
+	void update(const DetectedMarks &detectedMarks);
+};
+
+} /* namespace barcodes */
+#endif /* QRTRACKER_H_ */
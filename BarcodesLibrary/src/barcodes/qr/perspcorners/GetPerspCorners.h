@@ -62,7 +62,7 @@ public:
 	 * @param detectedMarks Detected marks. These marks are sorted.
 	 * @param corners Result corners for perspective transformation.
 	 */
-	virtual void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const {
+	virtual void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const {
 		corners.clear();
 	}
 };
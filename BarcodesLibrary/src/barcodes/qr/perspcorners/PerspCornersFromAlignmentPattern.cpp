@@ -29,7 +29,7 @@
 
 namespace barcodes {
 
-static PerspCornersFromFinderPattern perspFromFinderPattern;
+static const PerspCornersFromFinderPattern perspFromFinderPattern;
 
 /**
  * Retrieves four corners for perspective transformation and sorts the
@@ -65,7 +65,7 @@ static PerspCornersFromFinderPattern perspFromFinderPattern;
  * @param detectedMarks Detected marks. These marks are sorted.
  * @param corners Result corners for perspective transformation.
  */
-void PerspCornersFromAlignmentPattern::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const {
+void PerspCornersFromAlignmentPattern::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const {
 	corners.clear();
 	DetectedMarks _detectedMarks = detectedMarks;
 
@@ -117,11 +117,11 @@ void PerspCornersFromAlignmentPattern::getPerspectiveCorners(Mat &image, Mat &bi
 
 	// Transforming the fourth point back to the perspective projection
 
-	vector<Point> srcCorners;
-	srcCorners.push_back(Point(warpPerspectiveSize, 0));
-	srcCorners.push_back(Point(warpPerspectiveSize, warpPerspectiveSize));
-	srcCorners.push_back(Point(0, warpPerspectiveSize));
-	srcCorners.push_back(Point(0, 0));
+	vector<Point2f> srcCorners;
+	srcCorners.push_back(Point2f(warpPerspectiveSize, 0));
+	srcCorners.push_back(Point2f(warpPerspectiveSize, warpPerspectiveSize));
+	srcCorners.push_back(Point2f(0, warpPerspectiveSize));
+	srcCorners.push_back(Point2f(0, 0));
 	Mat transformation = getPerspectiveTransform(srcCorners, corners);
 
 	vector<Point2f> points2f;
@@ -137,10 +137,10 @@ void PerspCornersFromAlignmentPattern::getPerspectiveCorners(Mat &image, Mat &bi
 	// The outer point we will push as a result perspective points
 
 	corners.clear();
-	corners.push_back(detectedMarks[2].points[0]);
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[2], 0));
 	corners.push_back(res.at<Point2f>(0, 0));
-	corners.push_back(detectedMarks[0].points[0]);
-	corners.push_back(detectedMarks[1].points[0]);
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[0], 0));
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[1], 0));
 
 
 }
@@ -66,7 +66,7 @@ public:
 	 * @param detectedMarks Detected marks. These marks are sorted.
 	 * @param corners Result corners for perspective transformation.
 	 */
-	void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const;
+	void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const;
 };
 
 } /* namespace barcodes */
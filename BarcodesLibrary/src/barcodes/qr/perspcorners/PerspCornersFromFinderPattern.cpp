@@ -57,7 +57,7 @@ namespace barcodes {
  * @param detectedMarks Detected marks. These marks are sorted.
  * @param corners Result corners for perspective transformation.
  */
-void PerspCornersFromFinderPattern::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const {
+void PerspCornersFromFinderPattern::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const {
 
 	//============= DETERMINING THE THREE CORNERS (A, B, C) FROM THE DETECTED MARKS
 
@@ -69,25 +69,24 @@ void PerspCornersFromFinderPattern::getPerspectiveCorners(Mat &image, Mat &binar
 	//============= DETERMINING THE FROUTH UNKNOWN CORNER (D) BY RECT SAMPLING
 
 	// The start point from which sampling begins, its distance is equal to distance
-	Point2f pivotPoint = detectedMarks[0].points[0];
-	Vector2Df lineVector(detectedMarks[0].points[0], detectedMarks[0].points[3]);
+	Point2f pivotPoint = PerspCornersHelper::getCorner(detectedMarks[0], 0);
+	Vector2Df lineVector(pivotPoint, PerspCornersHelper::getCorner(detectedMarks[0], 3));
 
 	// Now find the second edge
-	Point2f pivotPoint2 = detectedMarks[2].points[0];
-	Vector2Df lineVector2(detectedMarks[2].points[0], detectedMarks[2].points[1]);
+	Point2f pivotPoint2 = PerspCornersHelper::getCorner(detectedMarks[2], 0);
+	Vector2Df lineVector2(pivotPoint2, PerspCornersHelper::getCorner(detectedMarks[2], 1));
 
 	// Finally finding the 4th corner from the intersection of the CN and AM lines
-	Point fourthCorner;
-	if (!Line2D::intersection(Line2D(pivotPoint, lineVector + pivotPoint),
-			Line2D(pivotPoint2, lineVector2 + pivotPoint2), fourthCorner)) {
+	Point2f fourthCorner;
+	if (!Line2Df::intersection(Line2Df(pivotPoint, lineVector), Line2Df(pivotPoint2, lineVector2), fourthCorner)) {
 		return;
 	}
 
 	// The outer point we will push as a result perspective points
-	corners.push_back(detectedMarks[2].points[0]);
+	corners.push_back(pivotPoint2);
 	corners.push_back(fourthCorner);
-	corners.push_back(detectedMarks[0].points[0]);
-	corners.push_back(detectedMarks[1].points[0]);
+	corners.push_back(pivotPoint);
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[1], 0));
 }
 
 } /* namespace barcodes */
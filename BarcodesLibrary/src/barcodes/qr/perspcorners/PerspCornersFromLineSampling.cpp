@@ -100,6 +100,7 @@ bool PerspCornersFromLineSampling::sampleQrCodeEdge(Mat &binarized, Vector2Df &s
  */
 double PerspCornersFromLineSampling::_sampleQrCodeEdge(Mat &binarized, Vector2Df &sampleVector, Point2f &rotatePoint, Vector2Df &lineShift, int lineWidth) const {
 	Mat transMat;
+	Mat transformed;
 	Point2f src[3];
 	Point2f dst[3];
 	double sampleSize = sampleVector.size();
@@ -169,7 +170,7 @@ double PerspCornersFromLineSampling::_sampleQrCodeEdge(Mat &binarized, Vector2Df
  * @param detectedMarks Detected marks. These marks are sorted.
  * @param corners Result corners for perspective transformation.
  */
-void PerspCornersFromLineSampling::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const {
+void PerspCornersFromLineSampling::getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const {
 
 	//============= DETERMINING THE THREE CORNERS (A, B, C) FROM THE DETECTED MARKS
 
@@ -186,13 +187,13 @@ void PerspCornersFromLineSampling::getPerspectiveCorners(Mat &image, Mat &binari
 	int sampleLineWidth = (boxSize.width > boxSize.height)? ceil(boxSize.width / (double)14) : ceil(boxSize.height / (double)14);
 
 	// The point around which will be sample rectangle rotated (point M)
-	Point2f rotatePoint = detectedMarks[0].points[3];
+	Point2f rotatePoint = PerspCornersHelper::getCorner(detectedMarks[0], 3);
 
 	// The start point from which sampling begins, its distance is equal to distance
 	// between the "center" of the QR code and is shifted SAMPLE_RECT_START_SHIFT degrees inside the QR code
-	Vector2Df diagVector(detectedMarks[0].points[0], detectedMarks[2].points[0]);
-	Vector2Df sampleVector(detectedMarks[0].points[0], detectedMarks[0].points[3]);
-	Vector2Df lineShift(detectedMarks[0].points[2], detectedMarks[0].points[3]);
+	Vector2Df diagVector(PerspCornersHelper::getCorner(detectedMarks[0], 0), PerspCornersHelper::getCorner(detectedMarks[2], 0));
+	Vector2Df sampleVector(PerspCornersHelper::getCorner(detectedMarks[0], 0), rotatePoint);
+	Vector2Df lineShift(PerspCornersHelper::getCorner(detectedMarks[0], 2), rotatePoint);
 	lineShift.resize(sampleLineWidth / 2);
 	sampleVector.rotate(SAMPLE_RECT_START_ANGLE_SHIFT);
 	sampleVector.resize(diagVector.size() / 2);
@@ -203,9 +204,9 @@ void PerspCornersFromLineSampling::getPerspectiveCorners(Mat &image, Mat &binari
 	}
 
 	// Now find the second edge
-	Point2f rotatePoint2 = detectedMarks[2].points[1];
-	Vector2Df sampleVector2(detectedMarks[2].points[0], detectedMarks[2].points[1]);
-	lineShift = Vector2Df(detectedMarks[2].points[2], detectedMarks[2].points[1]);
+	Point2f rotatePoint2 = PerspCornersHelper::getCorner(detectedMarks[2], 1);
+	Vector2Df sampleVector2(PerspCornersHelper::getCorner(detectedMarks[2], 0), rotatePoint2);
+	lineShift = Vector2Df(PerspCornersHelper::getCorner(detectedMarks[2], 2), rotatePoint2);
 	lineShift.resize(sampleLineWidth / 2);
 	sampleVector2.rotate(SAMPLE_RECT_START_ANGLE_SHIFT * -1);
 	sampleVector2.resize(diagVector.size() / 2);
@@ -216,17 +217,16 @@ void PerspCornersFromLineSampling::getPerspectiveCorners(Mat &image, Mat &binari
 	}
 
 	// Finally finding the 4th corner from the intersection of the lines
-	Point fourthCorner;
-	if (!Line2D::intersection(Line2D(rotatePoint, sampleVector + rotatePoint),
-			Line2D(rotatePoint2, sampleVector2 + rotatePoint2), fourthCorner)) {
+	Point2f fourthCorner;
+	if (!Line2Df::intersection(Line2Df(rotatePoint, sampleVector), Line2Df(rotatePoint2, sampleVector2), fourthCorner)) {
 		return;
 	}
 
 	// The outer point we will push as a result perspective points
-	corners.push_back(detectedMarks[2].points[0]);
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[2], 0));
 	corners.push_back(fourthCorner);
-	corners.push_back(detectedMarks[0].points[0]);
-	corners.push_back(detectedMarks[1].points[0]);
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[0], 0));
+	corners.push_back(PerspCornersHelper::getCorner(detectedMarks[1], 0));
 }
 
 } /* namespace barcodes */
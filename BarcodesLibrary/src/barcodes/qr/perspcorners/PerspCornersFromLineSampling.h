@@ -57,11 +57,6 @@ protected:
 	 */
 	static const double SAMPLE_RECT_FINAL_STEPS_COUNT           =    10;
 
-	/**
-	 * Temporary matrix for calculations.
-	 */
-	mutable Mat transformed;
-
 	/**
 	 * Proceeds sampling by rectangle.
 	 *
@@ -124,7 +119,7 @@ public:
 	 * @param detectedMarks Detected marks. These marks are sorted.
 	 * @param corners Result corners for perspective transformation.
 	 */
-	void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point> &corners) const;
+	void getPerspectiveCorners(Mat &image, Mat &binarized, DetectedMarks &detectedMarks, vector<Point2f> &corners) const;
 };
 
 } /* namespace barcodes */
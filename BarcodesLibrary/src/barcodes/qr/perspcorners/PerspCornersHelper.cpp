@@ -17,6 +17,8 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
+#include <algorithm>
+
 #include "PerspCornersHelper.h"
 #include "../../../common/Line2D.h"
 #include "../../../common/Polygon2D.h"
@@ -31,12 +33,12 @@ bool PerspCornersHelper::sortDetectedMarks(DetectedMarks &detectedMarks) {
 	}
 
 	// Sort each points of detected marks clockwise
+	sortMarkPoints(detectedMarks[0]);
 	vector<Point> *mark1_points = &detectedMarks[0].points;
-	convexHull(Mat(*mark1_points), *mark1_points);
+	sortMarkPoints(detectedMarks[1]);
 	vector<Point> *mark2_points = &detectedMarks[1].points;
-	convexHull(Mat(*mark2_points), *mark2_points);
+	sortMarkPoints(detectedMarks[2]);
 	vector<Point> *mark3_points = &detectedMarks[2].points;
-	convexHull(Mat(*mark3_points), *mark3_points);
 
 	// Get center of each mark
 	Point mark1_center;
@@ -88,6 +90,15 @@ bool PerspCornersHelper::sortDetectedMarks(DetectedMarks &detectedMarks) {
 	rotate((*mark2_points).begin(), (*mark2_points).begin() + (mark2_nearest_point_position + 2) % 4, (*mark2_points).end());
 	rotate((*mark3_points).begin(), (*mark3_points).begin() + (mark3_nearest_point_position + 2) % 4, (*mark3_points).end());
 
+	// Refined points are rotated the same way
+	int nearest_point_positions[] = {mark1_nearest_point_position, mark2_nearest_point_position, mark3_nearest_point_position};
+	for (int i = 0; i < 3; i++) {
+		vector<Point2f> &refinedPoints = detectedMarks[i].refinedPoints;
+		if (refinedPoints.size() == 4) {
+			rotate(refinedPoints.begin(), refinedPoints.begin() + (nearest_point_positions[i] + 2) % 4, refinedPoints.end());
+		}
+	}
+
 	// Sorting the detected marks too. First mark will be now left bottom and next clock-wise.
 	if ((mark1_nearest_point_distance >= mark2_nearest_point_distance) && (mark1_nearest_point_distance >= mark3_nearest_point_distance)) {
 		rotate(detectedMarks.begin(),detectedMarks.begin() + 2,detectedMarks.end());
@@ -98,4 +109,181 @@ bool PerspCornersHelper::sortDetectedMarks(DetectedMarks &detectedMarks) {
 	return true;
 }
 
+/**
+ * Refines the corners of the mark to the subpixel precision. Outer edges
+ * of the finder pattern are sampled across in the grayscale image, a line
+ * is fitted to the edge points of every side and the corners are
+ * the intersections of the neighbouring lines. Refined points are cleared
+ * if some side has too few edge points or the corner moves too far.
+ *
+ * @param image Grayscale image with the QR code.
+ * @param mark Mark whose refined points are set.
+ */
+void PerspCornersHelper::refineCorners(const Mat &image, DetectedMark &mark) {
+	mark.refinedPoints.clear();
+	if ((mark.points.size() != 4) || (image.type() != CV_8UC1)) return;
+
+	Point2f center(0, 0);
+	double perimeter = 0;
+	for (int i = 0; i < 4; i++) {
+		Point2f point = mark.points[i];
+		center += point * 0.25f;
+		perimeter += norm(mark.points[(i + 1) % 4] - mark.points[i]);
+	}
+
+	// Finder pattern is 7 modules wide, the search must not reach the inner edge of the outer ring
+	float moduleSize = perimeter / 28.0;
+	float range = max(moduleSize * (float)EDGE_SEARCH_RANGE, 1.5f);
+
+	Vec4f lines[4];
+	for (int i = 0; i < 4; i++) {
+		Point2f start = mark.points[i];
+		Point2f end = mark.points[(i + 1) % 4];
+		float length = norm(end - start);
+		if (length < 1) return;
+
+		// Normal of the side points out of the mark
+		Point2f direction((end.x - start.x) / length, (end.y - start.y) / length);
+		Point2f normal(-direction.y, direction.x);
+		if (normal.dot((start + end) * 0.5f - center) < 0) {
+			normal = -normal;
+		}
+
+		vector<Point2f> edgePoints;
+		for (int j = 0; j < EDGE_SAMPLES_PER_SIDE; j++) {
+			float position = (EDGE_SIDE_MARGIN + (1 - 2 * EDGE_SIDE_MARGIN) * j / (EDGE_SAMPLES_PER_SIDE - 1)) * length;
+			Point2f edge;
+			if (findEdge(image, start + direction * position, normal, range, edge)) {
+				edgePoints.push_back(edge);
+			}
+		}
+		if ((int)edgePoints.size() < EDGE_MINIMAL_POINTS) return;
+
+		fitLine(Mat(edgePoints), lines[i], CV_DIST_HUBER, 0, 0.01, 0.01);
+	}
+
+	// Corner lies on the end of the previous side and on the start of the next side
+	vector<Point2f> refinedPoints;
+	for (int i = 0; i < 4; i++) {
+		Vec4f &prev = lines[(i + 3) % 4];
+		Vec4f &next = lines[i];
+		Point2f corner;
+		if (!Line2Df::intersection(Line2Df(Point2f(prev[2], prev[3]), Vector2Df(prev[0], prev[1])),
+				Line2Df(Point2f(next[2], next[3]), Vector2Df(next[0], next[1])), corner)) {
+			return;
+		}
+
+		Point2f point = mark.points[i];
+		if (norm(corner - point) > moduleSize * CORNER_MAXIMAL_SHIFT) return;
+		refinedPoints.push_back(corner);
+	}
+
+	mark.refinedPoints = refinedPoints;
+}
+
+/**
+ * Returns the point of the mark, the refined one if the mark has been refined.
+ *
+ * @param mark Mark of the point.
+ * @param index Index of the point.
+ * @return Point of the mark in the subpixel precision.
+ */
+Point2f PerspCornersHelper::getCorner(const DetectedMark &mark, int index) {
+	if (mark.refinedPoints.size() == mark.points.size()) {
+		return mark.refinedPoints[index];
+	}
+
+	return mark.points[index];
+}
+
+/**
+ * Sorts the points of the mark clockwise, the refined points
+ * are kept in the same order.
+ *
+ * @param mark Mark whose points are sorted.
+ */
+void PerspCornersHelper::sortMarkPoints(DetectedMark &mark) {
+	vector<Point> hull;
+	convexHull(Mat(mark.points), hull);
+
+	// Refined points follow their points to the new positions
+	if (mark.refinedPoints.size() == mark.points.size()) {
+		vector<Point2f> refinedPoints;
+		for (unsigned int i = 0; i < hull.size(); i++) {
+			int position = find(mark.points.begin(), mark.points.end(), hull[i]) - mark.points.begin();
+			refinedPoints.push_back(mark.refinedPoints[position]);
+		}
+		mark.refinedPoints = refinedPoints;
+	} else {
+		mark.refinedPoints.clear();
+	}
+
+	mark.points = hull;
+}
+
+/**
+ * Finds the edge on the line across the side and returns
+ * its subpixel position.
+ *
+ * @param image Grayscale image.
+ * @param point Point on the side.
+ * @param normal Unit normal of the side.
+ * @param range Distance of the search on both sides [px].
+ * @param edge Output position of the edge.
+ * @return True if the edge with enough contrast has been found.
+ */
+bool PerspCornersHelper::findEdge(const Mat &image, Point2f point, Point2f normal, float range, Point2f &edge) {
+
+	// Profile is sampled by the half pixel steps
+	int steps = cvCeil(range * 2);
+	vector<float> profile(2 * steps + 1);
+	for (int i = -steps; i <= steps; i++) {
+		if (!interpolate(image, point + normal * (i * 0.5f), profile[i + steps])) return false;
+	}
+
+	// Gradient by the central differences, the edge is at its maximum
+	vector<float> gradient(profile.size(), 0);
+	int best = -1;
+	for (int i = 1; i + 1 < (int)profile.size(); i++) {
+		gradient[i] = fabs(profile[i + 1] - profile[i - 1]);
+		if ((best < 0) || (gradient[i] > gradient[best])) {
+			best = i;
+		}
+	}
+	if ((best < 0) || (gradient[best] < EDGE_MINIMAL_CONTRAST)) return false;
+
+	// Subpixel position from the vertex of the parabola through the neighbouring gradients
+	float offset = 0;
+	if ((best > 1) && (best + 2 < (int)profile.size())) {
+		float denominator = gradient[best - 1] - 2 * gradient[best] + gradient[best + 1];
+		if (denominator < 0) {
+			offset = 0.5f * (gradient[best - 1] - gradient[best + 1]) / denominator;
+		}
+	}
+
+	edge = point + normal * ((best - steps + offset) * 0.5f);
+	return true;
+}
+
+/**
+ * Returns the bilinearly interpolated intensity of the grayscale image.
+ *
+ * @param image Grayscale image.
+ * @param point Point of the image.
+ * @param value Output intensity.
+ * @return False if the point lies outside of the image.
+ */
+bool PerspCornersHelper::interpolate(const Mat &image, Point2f point, float &value) {
+	int x = cvFloor(point.x);
+	int y = cvFloor(point.y);
+	if ((x < 0) || (y < 0) || (x + 1 >= image.cols) || (y + 1 >= image.rows)) return false;
+
+	float fx = point.x - x;
+	float fy = point.y - y;
+	const uchar *row = image.ptr<uchar>(y);
+	const uchar *nextRow = image.ptr<uchar>(y + 1);
+	value = (row[x] * (1 - fx) + row[x + 1] * fx) * (1 - fy) + (nextRow[x] * (1 - fx) + nextRow[x + 1] * fx) * fy;
+	return true;
+}
+
 } /* namespace barcodes */
@@ -32,6 +32,90 @@ using namespace cv;
 class PerspCornersHelper {
 public:
 	static bool sortDetectedMarks(DetectedMarks &detectedMarks);
+
+	/**
+	 * Refines the corners of the mark to the subpixel precision. Outer edges
+	 * of the finder pattern are sampled across in the grayscale image, a line
+	 * is fitted to the edge points of every side and the corners are
+	 * the intersections of the neighbouring lines. Refined points are cleared
+	 * if some side has too few edge points or the corner moves too far.
+	 *
+	 * @param image Grayscale image with the QR code.
+	 * @param mark Mark whose refined points are set.
+	 */
+	static void refineCorners(const Mat &image, DetectedMark &mark);
+
+	/**
+	 * Returns the point of the mark, the refined one if the mark has been refined.
+	 *
+	 * @param mark Mark of the point.
+	 * @param index Index of the point.
+	 * @return Point of the mark in the subpixel precision.
+	 */
+	static Point2f getCorner(const DetectedMark &mark, int index);
+protected:
+
+	/**
+	 * Number of the edge samples across one side of the finder pattern.
+	 */
+	static const int EDGE_SAMPLES_PER_SIDE     = 12;
+
+	/**
+	 * Minimal number of the edge points for fitting the line of one side.
+	 */
+	static const int EDGE_MINIMAL_POINTS       = 6;
+
+	/**
+	 * Minimal difference of the intensities across the edge.
+	 */
+	static const int EDGE_MINIMAL_CONTRAST     = 24;
+
+	/**
+	 * Samples are taken only from the middle part of the side, ends are
+	 * skipped by this ratio of the side length.
+	 */
+	static const double EDGE_SIDE_MARGIN       = 0.15;
+
+	/**
+	 * Edge is searched in this distance from the side in the module sizes.
+	 */
+	static const double EDGE_SEARCH_RANGE      = 0.6;
+
+	/**
+	 * Maximal move of the refined corner in the module sizes.
+	 */
+	static const double CORNER_MAXIMAL_SHIFT   = 1.0;
+
+	/**
+	 * Sorts the points of the mark clockwise, the refined points
+	 * are kept in the same order.
+	 *
+	 * @param mark Mark whose points are sorted.
+	 */
+	static void sortMarkPoints(DetectedMark &mark);
+
+	/**
+	 * Finds the edge on the line across the side and returns
+	 * its subpixel position.
+	 *
+	 * @param image Grayscale image.
+	 * @param point Point on the side.
+	 * @param normal Unit normal of the side.
+	 * @param range Distance of the search on both sides [px].
+	 * @param edge Output position of the edge.
+	 * @return True if the edge with enough contrast has been found.
+	 */
+	static bool findEdge(const Mat &image, Point2f point, Point2f normal, float range, Point2f &edge);
+
+	/**
+	 * Returns the bilinearly interpolated intensity of the grayscale image.
+	 *
+	 * @param image Grayscale image.
+	 * @param point Point of the image.
+	 * @param value Output intensity.
+	 * @return False if the point lies outside of the image.
+	 */
+	static bool interpolate(const Mat &image, Point2f point, float &value);
 };
 
 } /* namespace barcodes */
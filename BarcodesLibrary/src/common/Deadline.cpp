@@ -0,0 +1,77 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       Deadline.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of Deadline class which bounds the time
+//             of the detection and decoding.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Deadline.cpp
+ *
+ * @brief Defines members of Deadline class which bounds the time
+ *        of the detection and decoding.
+ * @author agent agent(at)local
+ */
+
+#include <cfloat>
+
+#include "Deadline.h"
+
+namespace barcodes {
+
+/**
+ * Creates the deadline which never expires.
+ */
+Deadline::Deadline() : end(0), unlimited(true), exceeded(false) {
+}
+
+/**
+ * Creates the deadline which expires after the budget.
+ *
+ * @param budget Time budget from now [ms].
+ */
+Deadline::Deadline(double budget) : unlimited(false), exceeded(false) {
+	end = getTickCount() + (int64)(budget * getTickFrequency() / 1000.0);
+}
+
+/**
+ * Tests whether the deadline has expired. Stages call it before they start,
+ * the expiration is remembered.
+ *
+ * @return True if the deadline has expired and the stage should be skipped.
+ */
+bool Deadline::isExpired() const {
+	if (unlimited) return false;
+	if (exceeded) return true;
+
+	if (getTickCount() >= end) {
+		exceeded = true;
+	}
+
+	return exceeded;
+}
+
+/**
+ * Returns whether some stage has been skipped because of the expired deadline.
+ *
+ * @return True if the deadline has been exceeded.
+ */
+bool Deadline::isExceeded() const {
+	return exceeded;
+}
+
+/**
+ * Returns the remaining time of the budget.
+ *
+ * @return Remaining time [ms], negative if the deadline has expired, DBL_MAX if it never expires.
+ */
+double Deadline::getRemaining() const {
+	if (unlimited) return DBL_MAX;
+	return (end - getTickCount()) * 1000.0 / getTickFrequency();
+}
+
+} /* namespace barcodes */
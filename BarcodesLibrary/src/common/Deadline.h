@@ -0,0 +1,90 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       Deadline.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines Deadline class which bounds the time of the detection
+//             and decoding.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file Deadline.h
+ *
+ * @brief Defines Deadline class which bounds the time of the detection
+ *        and decoding.
+ * @author agent agent(at)local
+ */
+
+#ifndef DEADLINE_H_
+#define DEADLINE_H_
+
+#include <opencv2/core/core.hpp>
+
+namespace barcodes {
+using namespace cv;
+
+/**
+ * Time budget of one detection or decoding. Every stage checks the deadline
+ * before it starts and it is skipped if the deadline has expired, the started
+ * stages are not interrupted. The deadline remembers whether some stage has
+ * been skipped, so the caller knows that the result is not complete.
+ * Deadline can be checked from more threads at once.
+ */
+class Deadline {
+public:
+
+	/**
+	 * Creates the deadline which never expires.
+	 */
+	Deadline();
+
+	/**
+	 * Creates the deadline which expires after the budget.
+	 *
+	 * @param budget Time budget from now [ms].
+	 */
+	explicit Deadline(double budget);
+
+	/**
+	 * Tests whether the deadline has expired. Stages call it before they start,
+	 * the expiration is remembered.
+	 *
+	 * @return True if the deadline has expired and the stage should be skipped.
+	 */
+	bool isExpired() const;
+
+	/**
+	 * Returns whether some stage has been skipped because of the expired deadline.
+	 *
+	 * @return True if the deadline has been exceeded.
+	 */
+	bool isExceeded() const;
+
+	/**
+	 * Returns the remaining time of the budget.
+	 *
+	 * @return Remaining time [ms], negative if the deadline has expired, DBL_MAX if it never expires.
+	 */
+	double getRemaining() const;
+protected:
+
+	/**
+	 * Tick count when the deadline expires.
+	 */
+	int64 end;
+
+	/**
+	 * Whether the deadline is not bounded.
+	 */
+	bool unlimited;
+
+	/**
+	 * Whether some stage has been skipped.
+	 */
+	mutable volatile bool exceeded;
+};
+
+} /* namespace barcodes */
+#endif /* DEADLINE_H_ */
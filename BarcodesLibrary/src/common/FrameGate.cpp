@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       FrameGate.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of FrameGate class which skips the blurred
+//             and unchanged frames of the video stream before the detection.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file FrameGate.cpp
+ *
+ * @brief Defines members of FrameGate class which skips the blurred
+ *        and unchanged frames of the video stream before the detection.
+ * @author agent agent(at)local
+ */
+
+#include <cfloat>
+#include <cstdlib>
+
+#include "FrameGate.h"
+
+namespace barcodes {
+
+/**
+ * Default minimal variance of the Laplacian.
+ */
+const double FrameGate::DEFAULT_MIN_SHARPNESS = 50.0;
+
+/**
+ * Default minimal mean absolute difference [gray levels].
+ */
+const double FrameGate::DEFAULT_MIN_DIFFERENCE = 2.0;
+
+/**
+ * Creates the gate.
+ *
+ * @param minSharpness Minimal variance of the Laplacian, 0 disables the sharpness test.
+ * @param minDifference Minimal mean absolute difference to the last accepted frame, 0 disables the difference test.
+ * @param maxSkippedFrames Count of the frames which can be skipped in a row.
+ * @param gridWidth Count of the grid points in the row of the frame.
+ */
+FrameGate::FrameGate(double minSharpness, double minDifference, int maxSkippedFrames, int gridWidth) :
+		minSharpness(minSharpness), minDifference(minDifference), maxSkippedFrames(maxSkippedFrames),
+		gridWidth(gridWidth), skippedFrames(0), sharpness(0), difference(DBL_MAX) {
+}
+
+/**
+ * Scores the frame and decides whether it should be processed.
+ *
+ * @param image Grayscale frame.
+ * @return FRAME_ACCEPTED if the frame should be processed, otherwise the reason of the skip.
+ */
+int FrameGate::check(const Image &image) {
+	sharpness = sample(image, grid);
+	difference = DBL_MAX;
+	if (grid.empty()) return FRAME_ACCEPTED;
+
+	// Frame is compared with the last accepted one, so the slow drift is noticed too
+	if ((acceptedGrid.rows == grid.rows) && (acceptedGrid.cols == grid.cols)) {
+		difference = norm(grid, acceptedGrid, NORM_L1) / grid.total();
+	}
+
+	int result = FRAME_ACCEPTED;
+	if (skippedFrames < maxSkippedFrames) {
+		if (sharpness < minSharpness) {
+			result = FRAME_BLURRED;
+		} else if (difference < minDifference) {
+			result = FRAME_UNCHANGED;
+		}
+	}
+
+	if (result == FRAME_ACCEPTED) {
+		swap(grid, acceptedGrid);
+		skippedFrames = 0;
+	} else {
+		skippedFrames++;
+	}
+
+	return result;
+}
+
+/**
+ * Returns the sharpness of the last checked frame.
+ *
+ * @return Variance of the Laplacian.
+ */
+double FrameGate::getSharpness() const {
+	return sharpness;
+}
+
+/**
+ * Returns the difference of the last checked frame to the last accepted frame.
+ *
+ * @return Mean absolute difference [gray levels], DBL_MAX if there is no accepted frame.
+ */
+double FrameGate::getDifference() const {
+	return difference;
+}
+
+/**
+ * Sets the thresholds of the gate.
+ *
+ * @param minSharpness Minimal variance of the Laplacian, 0 disables the sharpness test.
+ * @param minDifference Minimal mean absolute difference to the last accepted frame, 0 disables the difference test.
+ * @param maxSkippedFrames Count of the frames which can be skipped in a row.
+ */
+void FrameGate::setThresholds(double minSharpness, double minDifference, int maxSkippedFrames) {
+	this->minSharpness = minSharpness;
+	this->minDifference = minDifference;
+	this->maxSkippedFrames = maxSkippedFrames;
+}
+
+/**
+ * Forgets the last accepted frame, the next frame is compared only by the sharpness.
+ */
+void FrameGate::reset() {
+	acceptedGrid.release();
+	skippedFrames = 0;
+}
+
+/**
+ * Samples the decimated plane of the frame and computes the variance
+ * of the Laplacian at the sampled points.
+ *
+ * @param image Grayscale frame.
+ * @param grid Output decimated plane.
+ * @return Variance of the Laplacian.
+ */
+double FrameGate::sample(const Mat &image, Mat &grid) const {
+	if ((image.rows < 3) || (image.cols < 3) || (image.type() != CV_8UC1)) {
+		grid.release();
+		return 0;
+	}
+
+	// Laplacian uses the neighbours of the full resolution, so the focus is measured
+	// on the original scale, only the count of the points is reduced
+	int step = max(1, image.cols / gridWidth);
+	grid.create((image.rows - 3) / step + 1, (image.cols - 3) / step + 1, CV_8UC1);
+
+	double sum = 0;
+	double sumSquares = 0;
+	for (int i = 0; i < grid.rows; i++) {
+		const uchar *prevRow = image.ptr<uchar>(i * step);
+		const uchar *row = image.ptr<uchar>(i * step + 1);
+		const uchar *nextRow = image.ptr<uchar>(i * step + 2);
+		uchar *gridRow = grid.ptr<uchar>(i);
+
+		for (int j = 0, x = 1; j < grid.cols; j++, x += step) {
+			int laplacian = prevRow[x] + nextRow[x] + row[x - 1] + row[x + 1] - 4 * row[x];
+			sum += laplacian;
+			sumSquares += laplacian * laplacian;
+			gridRow[j] = row[x];
+		}
+	}
+
+	double count = grid.total();
+	double mean = sum / count;
+	return sumSquares / count - mean * mean;
+}
+
+} /* namespace barcodes */
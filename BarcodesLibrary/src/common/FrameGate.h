@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       FrameGate.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines FrameGate class which skips the blurred and unchanged
+//             frames of the video stream before the detection.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file FrameGate.h
+ *
+ * @brief Defines FrameGate class which skips the blurred and unchanged
+ *        frames of the video stream before the detection.
+ * @author agent agent(at)local
+ */
+
+#ifndef FRAMEGATE_H_
+#define FRAMEGATE_H_
+
+#include <opencv2/core/core.hpp>
+
+#include "Image.h"
+
+namespace barcodes {
+using namespace cv;
+
+/**
+ * Gate of the video stream which decides whether the frame is worth of the detection.
+ * Scores are computed only on the sparse grid of the luma pixels (decimated plane).
+ * Sharpness is the variance of the Laplacian at the grid points, the difference
+ * is the mean absolute difference of the grid to the last accepted frame.
+ * Frame is skipped if it is blurred or if it has not changed since the last accepted
+ * frame, after too many skipped frames the frame is accepted anyway.
+ * Gate is not thread safe, every video stream has to use its own gate.
+ */
+class FrameGate {
+public:
+	static const int FRAME_ACCEPTED = 0;	/**< Frame should be processed */
+	static const int FRAME_BLURRED = 1;		/**< Frame is too blurred, it should be skipped */
+	static const int FRAME_UNCHANGED = 2;	/**< Frame has not changed since the last accepted frame */
+
+	static const double DEFAULT_MIN_SHARPNESS;	/**< Default minimal variance of the Laplacian */
+	static const double DEFAULT_MIN_DIFFERENCE;	/**< Default minimal mean absolute difference [gray levels] */
+	static const int DEFAULT_MAX_SKIPPED_FRAMES = 15; /**< Default count of the frames which can be skipped in a row */
+	static const int DEFAULT_GRID_WIDTH = 160;	/**< Default count of the grid points in the row */
+
+	/**
+	 * Creates the gate.
+	 *
+	 * @param minSharpness Minimal variance of the Laplacian, 0 disables the sharpness test.
+	 * @param minDifference Minimal mean absolute difference to the last accepted frame, 0 disables the difference test.
+	 * @param maxSkippedFrames Count of the frames which can be skipped in a row.
+	 * @param gridWidth Count of the grid points in the row of the frame.
+	 */
+	FrameGate(double minSharpness = DEFAULT_MIN_SHARPNESS, double minDifference = DEFAULT_MIN_DIFFERENCE,
+			int maxSkippedFrames = DEFAULT_MAX_SKIPPED_FRAMES, int gridWidth = DEFAULT_GRID_WIDTH);
+	virtual ~FrameGate() {}
+
+	/**
+	 * Scores the frame and decides whether it should be processed.
+	 *
+	 * @param image Grayscale frame.
+	 * @return FRAME_ACCEPTED if the frame should be processed, otherwise the reason of the skip.
+	 */
+	int check(const Image &image);
+
+	/**
+	 * Returns the sharpness of the last checked frame.
+	 *
+	 * @return Variance of the Laplacian.
+	 */
+	double getSharpness() const;
+
+	/**
+	 * Returns the difference of the last checked frame to the last accepted frame.
+	 *
+	 * @return Mean absolute difference [gray levels], DBL_MAX if there is no accepted frame.
+	 */
+	double getDifference() const;
+
+	/**
+	 * Sets the thresholds of the gate.
+	 *
+	 * @param minSharpness Minimal variance of the Laplacian, 0 disables the sharpness test.
+	 * @param minDifference Minimal mean absolute difference to the last accepted frame, 0 disables the difference test.
+	 * @param maxSkippedFrames Count of the frames which can be skipped in a row.
+	 */
+	void setThresholds(double minSharpness, double minDifference, int maxSkippedFrames);
+
+	/**
+	 * Forgets the last accepted frame, the next frame is compared only by the sharpness.
+	 */
+	void reset();
+protected:
+	double minSharpness;	/**< Minimal variance of the Laplacian */
+	double minDifference;	/**< Minimal mean absolute difference to the last accepted frame */
+	int maxSkippedFrames;	/**< Count of the frames which can be skipped in a row */
+	int gridWidth;			/**< Count of the grid points in the row */
+
+	int skippedFrames;		/**< Count of the frames skipped in a row */
+	double sharpness;		/**< Sharpness of the last checked frame */
+	double difference;		/**< Difference of the last checked frame */
+	Mat grid;				/**< Decimated plane of the last checked frame */
+	Mat acceptedGrid;		/**< Decimated plane of the last accepted frame */
+
+	/**
+	 * Samples the decimated plane of the frame and computes the variance
+	 * of the Laplacian at the sampled points.
+	 *
+	 * @param image Grayscale frame.
+	 * @param grid Output decimated plane.
+	 * @return Variance of the Laplacian.
+	 */
+	double sample(const Mat &image, Mat &grid) const;
+};
+
+} /* namespace barcodes */
+#endif /* FRAMEGATE_H_ */
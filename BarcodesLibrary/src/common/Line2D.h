@@ -42,7 +42,7 @@ public:
 	 * @param pivot Pivot point of the line. Just some point which belongs to line.
 	 * @param slopeVector Slope vector of the line which defines direction.
 	 */
-	Line2D_(Point_<T> pivot, Vector2D_<T> slopeVector) : slopeVector(slopeVector), pivot(pivot) {}
+	Line2D_(Point_<T> pivot, Vector2D_<T> slopeVector) : pivot(pivot), slopeVector(slopeVector) {}
 
 	/**
 	 * Constructs the line from two points which lies on the line.
@@ -0,0 +1,603 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       MeanThreshold.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of MeanThreshold class which implements
+//             adaptive mean threshold with SSE2/AVX2 kernels selected
+//             at runtime.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MeanThreshold.cpp
+ *
+ * @brief Defines members of MeanThreshold class which implements
+ *        adaptive mean threshold with SSE2/AVX2 kernels selected
+ *        at runtime.
+ * @author agent agent(at)local
+ */
+
+#include <climits>
+#include <vector>
+#include <pthread.h>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "MeanThreshold.h"
+#include "ThreadPool.h"
+
+// Vector kernels are compiled by the function target attributes, so no special
+// compiler flags are needed and the library still runs on any x86 CPU.
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__)) && \
+	(__GNUC__ > 4 || (__GNUC__ == 4 && __GNUC_MINOR__ >= 9) || defined(__clang__))
+	#define MEAN_THRESHOLD_X86
+	#include <immintrin.h>
+#endif
+
+namespace barcodes {
+using namespace std;
+
+/**
+ * Set of the kernels of one instruction set.
+ */
+struct MeanThresholdKernels {
+
+	/**
+	 * Adds one row to the column sums and subtracts another one.
+	 */
+	void (*accumulate)(uint32_t *colSums, const uchar *add, const uchar *sub, int n);
+
+	/**
+	 * Subtracts two arrays of the sums.
+	 */
+	void (*difference)(const uint32_t *minuend, const uint32_t *subtrahend, int n, uint32_t *dst);
+
+	/**
+	 * Thresholds the row, mean_C has to be in range <-256, 256>.
+	 */
+	void (*thresholdRow)(const uchar *src, const uint32_t *sums, int n, double scale, int mean_C, uchar *dst);
+
+	/**
+	 * Calculates the means of the row.
+	 */
+	void (*meanRow)(const uint32_t *sums, int n, double scale, uchar *dst);
+};
+
+//>>> Scalar kernels
+
+static void accumulateScalar(uint32_t *colSums, const uchar *add, const uchar *sub, int n) {
+	for (int i = 0; i < n; i++) {
+		colSums[i] += add[i] - sub[i];
+	}
+}
+
+static void differenceScalar(const uint32_t *minuend, const uint32_t *subtrahend, int n, uint32_t *dst) {
+	for (int i = 0; i < n; i++) {
+		dst[i] = minuend[i] - subtrahend[i];
+	}
+}
+
+static void thresholdRowScalar(const uchar *src, const uint32_t *sums, int n, double scale, int mean_C, uchar *dst) {
+	for (int i = 0; i < n; i++) {
+		int mean = saturate_cast<uchar>(sums[i] * scale);
+		dst[i] = (src[i] - mean > -mean_C)? 255 : 0;
+	}
+}
+
+static void meanRowScalar(const uint32_t *sums, int n, double scale, uchar *dst) {
+	for (int i = 0; i < n; i++) {
+		dst[i] = saturate_cast<uchar>(sums[i] * scale);
+	}
+}
+
+static const MeanThresholdKernels SCALAR_KERNELS = {
+	accumulateScalar, differenceScalar, thresholdRowScalar, meanRowScalar
+};
+
+#ifdef MEAN_THRESHOLD_X86
+
+//>>> SSE2 kernels
+
+__attribute__((target("sse2")))
+static void accumulateSse2(uint32_t *colSums, const uchar *add, const uchar *sub, int n) {
+	__m128i zero = _mm_setzero_si128();
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i addBytes = _mm_loadu_si128((const __m128i *)(add + i));
+		__m128i subBytes = _mm_loadu_si128((const __m128i *)(sub + i));
+
+		// Differences fit into 16 bits, then they are sign extended to 32 bits
+		__m128i diffLow = _mm_sub_epi16(_mm_unpacklo_epi8(addBytes, zero), _mm_unpacklo_epi8(subBytes, zero));
+		__m128i diffHigh = _mm_sub_epi16(_mm_unpackhi_epi8(addBytes, zero), _mm_unpackhi_epi8(subBytes, zero));
+		__m128i diff[4] = {
+			_mm_srai_epi32(_mm_unpacklo_epi16(diffLow, diffLow), 16),
+			_mm_srai_epi32(_mm_unpackhi_epi16(diffLow, diffLow), 16),
+			_mm_srai_epi32(_mm_unpacklo_epi16(diffHigh, diffHigh), 16),
+			_mm_srai_epi32(_mm_unpackhi_epi16(diffHigh, diffHigh), 16)
+		};
+
+		for (int j = 0; j < 4; j++) {
+			__m128i *sums = (__m128i *)(colSums + i + j * 4);
+			_mm_storeu_si128(sums, _mm_add_epi32(_mm_loadu_si128(sums), diff[j]));
+		}
+	}
+
+	accumulateScalar(colSums + i, add + i, sub + i, n - i);
+}
+
+__attribute__((target("sse2")))
+static void differenceSse2(const uint32_t *minuend, const uint32_t *subtrahend, int n, uint32_t *dst) {
+	int i = 0;
+
+	for (; i + 4 <= n; i += 4) {
+		__m128i a = _mm_loadu_si128((const __m128i *)(minuend + i));
+		__m128i b = _mm_loadu_si128((const __m128i *)(subtrahend + i));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_sub_epi32(a, b));
+	}
+
+	differenceScalar(minuend + i, subtrahend + i, n - i, dst + i);
+}
+
+/**
+ * Calculates 4 means, rounding is the same as of the cvRound (current rounding mode).
+ */
+__attribute__((target("sse2")))
+static inline __m128i means4Sse2(const uint32_t *sums, __m128d scale) {
+	__m128i s = _mm_loadu_si128((const __m128i *)sums);
+	__m128i low = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(s), scale));
+	__m128i high = _mm_cvtpd_epi32(_mm_mul_pd(_mm_cvtepi32_pd(_mm_srli_si128(s, 8)), scale));
+	return _mm_unpacklo_epi64(low, high);
+}
+
+__attribute__((target("sse2")))
+static void thresholdRowSse2(const uchar *src, const uint32_t *sums, int n, double scale, int mean_C, uchar *dst) {
+	__m128d vScale = _mm_set1_pd(scale);
+	__m128i vMeanC = _mm_set1_epi16((short)mean_C);
+	__m128i zero = _mm_setzero_si128();
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i meanLow = _mm_packs_epi32(means4Sse2(sums + i, vScale), means4Sse2(sums + i + 4, vScale));
+		__m128i meanHigh = _mm_packs_epi32(means4Sse2(sums + i + 8, vScale), means4Sse2(sums + i + 12, vScale));
+		__m128i pixels = _mm_loadu_si128((const __m128i *)(src + i));
+
+		// pixel - mean > -C  <=>  pixel + C > mean
+		__m128i resLow = _mm_cmpgt_epi16(_mm_add_epi16(_mm_unpacklo_epi8(pixels, zero), vMeanC), meanLow);
+		__m128i resHigh = _mm_cmpgt_epi16(_mm_add_epi16(_mm_unpackhi_epi8(pixels, zero), vMeanC), meanHigh);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi16(resLow, resHigh));
+	}
+
+	thresholdRowScalar(src + i, sums + i, n - i, scale, mean_C, dst + i);
+}
+
+__attribute__((target("sse2")))
+static void meanRowSse2(const uint32_t *sums, int n, double scale, uchar *dst) {
+	__m128d vScale = _mm_set1_pd(scale);
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m128i meanLow = _mm_packs_epi32(means4Sse2(sums + i, vScale), means4Sse2(sums + i + 4, vScale));
+		__m128i meanHigh = _mm_packs_epi32(means4Sse2(sums + i + 8, vScale), means4Sse2(sums + i + 12, vScale));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(meanLow, meanHigh));
+	}
+
+	meanRowScalar(sums + i, n - i, scale, dst + i);
+}
+
+static const MeanThresholdKernels SSE2_KERNELS = {
+	accumulateSse2, differenceSse2, thresholdRowSse2, meanRowSse2
+};
+
+//>>> AVX2 kernels
+
+__attribute__((target("avx2")))
+static void accumulateAvx2(uint32_t *colSums, const uchar *add, const uchar *sub, int n) {
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i addInts = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(add + i)));
+		__m256i subInts = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(sub + i)));
+		__m256i *sums = (__m256i *)(colSums + i);
+		_mm256_storeu_si256(sums, _mm256_add_epi32(_mm256_loadu_si256(sums), _mm256_sub_epi32(addInts, subInts)));
+	}
+
+	accumulateScalar(colSums + i, add + i, sub + i, n - i);
+}
+
+__attribute__((target("avx2")))
+static void differenceAvx2(const uint32_t *minuend, const uint32_t *subtrahend, int n, uint32_t *dst) {
+	int i = 0;
+
+	for (; i + 8 <= n; i += 8) {
+		__m256i a = _mm256_loadu_si256((const __m256i *)(minuend + i));
+		__m256i b = _mm256_loadu_si256((const __m256i *)(subtrahend + i));
+		_mm256_storeu_si256((__m256i *)(dst + i), _mm256_sub_epi32(a, b));
+	}
+
+	differenceScalar(minuend + i, subtrahend + i, n - i, dst + i);
+}
+
+/**
+ * Calculates 8 means packed to 16 bits, rounding is the same as of the cvRound.
+ */
+__attribute__((target("avx2")))
+static inline __m128i means8Avx2(const uint32_t *sums, __m256d scale) {
+	__m128i low = _mm_loadu_si128((const __m128i *)sums);
+	__m128i high = _mm_loadu_si128((const __m128i *)(sums + 4));
+	return _mm_packs_epi32(
+			_mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(low), scale)),
+			_mm256_cvtpd_epi32(_mm256_mul_pd(_mm256_cvtepi32_pd(high), scale)));
+}
+
+__attribute__((target("avx2")))
+static void thresholdRowAvx2(const uchar *src, const uint32_t *sums, int n, double scale, int mean_C, uchar *dst) {
+	__m256d vScale = _mm256_set1_pd(scale);
+	__m256i vMeanC = _mm256_set1_epi16((short)mean_C);
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		__m256i means = _mm256_inserti128_si256(_mm256_castsi128_si256(means8Avx2(sums + i, vScale)),
+				means8Avx2(sums + i + 8, vScale), 1);
+		__m256i pixels = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i *)(src + i)));
+
+		// pixel - mean > -C  <=>  pixel + C > mean
+		__m256i res = _mm256_cmpgt_epi16(_mm256_add_epi16(pixels, vMeanC), means);
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packs_epi16(_mm256_castsi256_si128(res), _mm256_extracti128_si256(res, 1)));
+	}
+
+	thresholdRowScalar(src + i, sums + i, n - i, scale, mean_C, dst + i);
+}
+
+__attribute__((target("avx2")))
+static void meanRowAvx2(const uint32_t *sums, int n, double scale, uchar *dst) {
+	__m256d vScale = _mm256_set1_pd(scale);
+	int i = 0;
+
+	for (; i + 16 <= n; i += 16) {
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_packus_epi16(means8Avx2(sums + i, vScale), means8Avx2(sums + i + 8, vScale)));
+	}
+
+	meanRowScalar(sums + i, n - i, scale, dst + i);
+}
+
+static const MeanThresholdKernels AVX2_KERNELS = {
+	accumulateAvx2, differenceAvx2, thresholdRowAvx2, meanRowAvx2
+};
+
+#endif
+
+/**
+ * Currently used kernels, selected on the first use.
+ */
+static const MeanThresholdKernels *usedKernels = NULL;
+
+/**
+ * Instructions of the currently used kernels.
+ */
+static int usedInstructions = MeanThreshold::INSTRUCTIONS_SCALAR;
+
+/**
+ * Returns the kernels for the specified instructions.
+ *
+ * @param instructions Instructions of the kernels.
+ * @return Kernels of the instructions.
+ */
+static const MeanThresholdKernels *getInstructionsKernels(int instructions) {
+#ifdef MEAN_THRESHOLD_X86
+	switch (instructions) {
+		case MeanThreshold::INSTRUCTIONS_AVX2: return &AVX2_KERNELS;
+		case MeanThreshold::INSTRUCTIONS_SSE2: return &SSE2_KERNELS;
+	}
+#endif
+	return &SCALAR_KERNELS;
+}
+
+/**
+ * Selects the best kernels supported by the CPU.
+ */
+static void selectKernels() {
+	int instructions = MeanThreshold::INSTRUCTIONS_SCALAR;
+	if (MeanThreshold::isSupported(MeanThreshold::INSTRUCTIONS_AVX2)) {
+		instructions = MeanThreshold::INSTRUCTIONS_AVX2;
+	} else if (MeanThreshold::isSupported(MeanThreshold::INSTRUCTIONS_SSE2)) {
+		instructions = MeanThreshold::INSTRUCTIONS_SSE2;
+	}
+
+	usedInstructions = instructions;
+	usedKernels = getInstructionsKernels(instructions);
+}
+
+/**
+ * Returns the currently used kernels, selects the best supported on the first call.
+ * Selection is done only once even if more threads binarize at once.
+ *
+ * @return Currently used kernels.
+ */
+static const MeanThresholdKernels *getKernels() {
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, selectKernels);
+	return usedKernels;
+}
+
+/**
+ * Returns the kernels which can be used for the sums of the specified block size.
+ * Vector kernels convert sums as signed 32-bit values.
+ *
+ * @param blockSize Size of the block.
+ * @return Kernels for the block size.
+ */
+static const MeanThresholdKernels *getBlockSizeKernels(int blockSize) {
+	if ((int64)blockSize * blockSize * 255 > INT_MAX) {
+		return &SCALAR_KERNELS;
+	}
+
+	return getKernels();
+}
+
+/**
+ * Binarizes the rows of the image by adaptive mean threshold or calculates their
+ * means. Running sums are initialized from the halo rows above the first row of the band.
+ *
+ * @param src Grayscale image.
+ * @param dst Output binarized image or means.
+ * @param blockSize Size of the block from which is calculated the mean.
+ * @param mean_C Constant which offsets threshold value.
+ * @param threshold Whether to threshold the rows or to calculate the means.
+ * @param rowFrom First row of the band.
+ * @param rowTo Row after the last row of the band.
+ */
+static void processRows(const Mat &src, Mat &dst, int blockSize, int mean_C, bool threshold, int rowFrom, int rowTo) {
+	int rows = src.rows;
+	int cols = src.cols;
+	int radius = blockSize / 2;
+
+	const MeanThresholdKernels *kernels = getKernels();
+	vector<uchar> zeroRow(cols, 0);
+	vector<uint32_t> colSums(cols, 0);
+	vector<uint32_t> prefix(cols + 1);
+	vector<uint32_t> sums(cols);
+
+	// Column sums of the first row, rows outside the image are replicated
+	for (int row = rowFrom - radius; row <= rowFrom + radius; row++) {
+		kernels->accumulate(&colSums[0], src.ptr<uchar>(min(max(row, 0), rows - 1)), &zeroRow[0], cols);
+	}
+
+	for (int row = rowFrom; row < rowTo; row++) {
+		if (row > rowFrom) {
+			kernels->accumulate(&colSums[0], src.ptr<uchar>(min(row + radius, rows - 1)),
+					src.ptr<uchar>(max(row - radius - 1, 0)), cols);
+		}
+
+		prefix[0] = 0;
+		for (int col = 0; col < cols; col++) {
+			prefix[col + 1] = prefix[col] + colSums[col];
+		}
+
+		MeanThreshold::boxSums(&prefix[0], cols, blockSize, &sums[0]);
+		if (threshold) {
+			MeanThreshold::thresholdRow(src.ptr<uchar>(row), &sums[0], cols, blockSize, mean_C, dst.ptr<uchar>(row));
+		} else {
+			MeanThreshold::meanRow(&sums[0], cols, blockSize, dst.ptr<uchar>(row));
+		}
+	}
+}
+
+/**
+ * Parallel task which binarizes bands of the image or calculates their means.
+ */
+class ProcessRowsTask : public ParallelTask {
+public:
+	ProcessRowsTask(const Mat &src, Mat &dst, int blockSize, int mean_C, bool threshold) :
+		src(src), dst(dst), blockSize(blockSize), mean_C(mean_C), threshold(threshold) {}
+
+	void run(int from, int to) {
+		processRows(src, dst, blockSize, mean_C, threshold, from, to);
+	}
+protected:
+	const Mat &src;
+	Mat &dst;
+	int blockSize;
+	int mean_C;
+	bool threshold;
+};
+
+/**
+ * Binarizes the image or calculates its means by the running sums.
+ *
+ * @param image Grayscale image (CV_8UC1).
+ * @param dst Output binarized image or means.
+ * @param blockSize Size of the block from which is calculated the mean (odd number).
+ * @param mean_C Constant which offsets threshold value.
+ * @param threshold Whether to threshold the image or to calculate the means.
+ * @param parallel Whether to process the horizontal bands of the image on the thread pool.
+ */
+static void processImage(const Mat &image, Mat &dst, int blockSize, int mean_C, bool threshold, bool parallel) {
+	// Running sums read rows after the currently written one, so it cannot be done in place
+	Mat src = (dst.data == image.data)? image.clone() : image;
+
+	dst.create(src.rows, src.cols, CV_8UC1);
+	if ((src.rows == 0) || (src.cols == 0)) return;
+
+	if (parallel) {
+		ThreadPool *threadPool = ThreadPool::getInstance();
+		getKernels();
+
+		// Every band reads block size halo rows for its first row, so bands are not lower than the block
+		int bandHeight = (src.rows + threadPool->getThreadsCount() - 1) / threadPool->getThreadsCount();
+		ProcessRowsTask task(src, dst, blockSize, mean_C, threshold);
+		threadPool->parallelFor(0, src.rows, max(bandHeight, blockSize), task);
+	} else {
+		processRows(src, dst, blockSize, mean_C, threshold, 0, src.rows);
+	}
+}
+
+/**
+ * Binarizes the image by adaptive mean threshold to values 0 and 255.
+ * Box sums are calculated by separable running sums.
+ *
+ * pixel = ( pixel > mean - C ) ? 255 : 0
+ *
+ * @param image Grayscale image (CV_8UC1).
+ * @param binarized Output binarized image.
+ * @param blockSize Size of the block from which is calculated the mean (odd number).
+ * @param mean_C Constant which offsets threshold value.
+ * @param parallel Whether to binarize the horizontal bands of the image on the thread pool.
+ */
+void MeanThreshold::threshold(const Mat &image, Mat &binarized, int blockSize, int mean_C, bool parallel) {
+	if (!isApplicable(blockSize)) {
+		adaptiveThreshold(image, binarized, 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY, blockSize, mean_C);
+		return;
+	}
+
+	processImage(image, binarized, blockSize, mean_C, true, parallel);
+}
+
+/**
+ * Calculates means of the image, result is the same as of the normalized
+ * boxFilter with BORDER_REPLICATE. Box sums are calculated by separable running sums.
+ *
+ * @param image Grayscale image (CV_8UC1).
+ * @param mean Output means.
+ * @param blockSize Size of the block from which is calculated the mean (odd number).
+ * @param parallel Whether to process the horizontal bands of the image on the thread pool.
+ */
+void MeanThreshold::mean(const Mat &image, Mat &mean, int blockSize, bool parallel) {
+	if (!isApplicable(blockSize)) {
+		boxFilter(image, mean, image.type(), Size(blockSize, blockSize), Point(-1,-1), true, BORDER_REPLICATE);
+		return;
+	}
+
+	processImage(image, mean, blockSize, 0, false, parallel);
+}
+
+/**
+ * Calculates the box sums of one row from the prefix sums of the block columns.
+ * Columns outside the image are replicated from the border.
+ *
+ * @param colSums Prefix sums of the block columns (cols + 1 values, first is zero).
+ * @param cols Number of the columns of the row.
+ * @param blockSize Size of the block.
+ * @param sums Output box sums (cols values).
+ */
+void MeanThreshold::boxSums(const uint32_t *colSums, int cols, int blockSize, uint32_t *sums) {
+	int radius = blockSize / 2;
+	uint32_t firstCol = colSums[1] - colSums[0];
+	uint32_t lastCol = colSums[cols] - colSums[cols - 1];
+
+	// Columns which blocks lie inside the image do not need any correction
+	int innerFrom = min(radius, cols);
+	int innerTo = max(cols - radius, innerFrom);
+
+	for (int col = 0; col < innerFrom; col++) {
+		int colFrom = max(col - radius, 0);
+		int colTo = min(col + radius, cols - 1);
+		sums[col] = colSums[colTo + 1] - colSums[colFrom] + (uint32_t)(colFrom - (col - radius)) * firstCol
+				+ (uint32_t)((col + radius) - colTo) * lastCol;
+	}
+
+	if (innerTo > innerFrom) {
+		getKernels()->difference(colSums + innerFrom + radius + 1, colSums + innerFrom - radius,
+				innerTo - innerFrom, sums + innerFrom);
+	}
+
+	for (int col = innerTo; col < cols; col++) {
+		int colFrom = max(col - radius, 0);
+		int colTo = min(col + radius, cols - 1);
+		sums[col] = colSums[colTo + 1] - colSums[colFrom] + (uint32_t)(colFrom - (col - radius)) * firstCol
+				+ (uint32_t)((col + radius) - colTo) * lastCol;
+	}
+}
+
+/**
+ * Binarizes one row by the box sums of its pixels.
+ *
+ * @param src Pixels of the row.
+ * @param sums Box sums of the pixels.
+ * @param cols Number of the columns of the row.
+ * @param blockSize Size of the block of the sums.
+ * @param mean_C Constant which offsets threshold value.
+ * @param dst Output binarized row.
+ */
+void MeanThreshold::thresholdRow(const uchar *src, const uint32_t *sums, int cols, int blockSize, int mean_C, uchar *dst) {
+	// Pixel and mean differ at most by 255, so larger constants give the same results
+	mean_C = min(max(mean_C, -256), 256);
+	getBlockSizeKernels(blockSize)->thresholdRow(src, sums, cols, 1.0 / (blockSize * blockSize), mean_C, dst);
+}
+
+/**
+ * Calculates means of one row from the box sums of its pixels.
+ *
+ * @param sums Box sums of the pixels.
+ * @param cols Number of the columns of the row.
+ * @param blockSize Size of the block of the sums.
+ * @param dst Output means.
+ */
+void MeanThreshold::meanRow(const uint32_t *sums, int cols, int blockSize, uchar *dst) {
+	getBlockSizeKernels(blockSize)->meanRow(sums, cols, 1.0 / (blockSize * blockSize), dst);
+}
+
+/**
+ * Tests whether the box sums of the specified block size fits into 32 bits.
+ *
+ * @param blockSize Size of the block.
+ * @return True if the kernels can be used for this block size.
+ */
+bool MeanThreshold::isApplicable(int blockSize) {
+	return (uint64_t)blockSize * (uint64_t)blockSize * 255 <= (uint64_t)0xFFFFFFFF;
+}
+
+/**
+ * Returns the instructions of the used kernels.
+ *
+ * @return Instructions of the used kernels.
+ */
+int MeanThreshold::getInstructions() {
+	getKernels();
+	return usedInstructions;
+}
+
+/**
+ * Tests whether the kernels with specified instructions are supported by the CPU.
+ *
+ * @param instructions Instructions of the kernels.
+ * @return True if kernels are supported, otherwise false.
+ */
+bool MeanThreshold::isSupported(int instructions) {
+	switch (instructions) {
+		case INSTRUCTIONS_SCALAR:
+			return true;
+#ifdef MEAN_THRESHOLD_X86
+		case INSTRUCTIONS_SSE2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("sse2");
+		case INSTRUCTIONS_AVX2:
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2");
+#endif
+	}
+
+	return false;
+}
+
+/**
+ * Sets the kernels which should be used. Not thread safe, it is intended
+ * for testing of the kernels.
+ *
+ * @param instructions Instructions of the kernels.
+ * @return True if kernels have been set, false if they are not supported.
+ */
+bool MeanThreshold::setInstructions(int instructions) {
+	if (!isSupported(instructions)) {
+		return false;
+	}
+
+	// The first selection must not override the set kernels later
+	getKernels();
+	usedInstructions = instructions;
+	usedKernels = getInstructionsKernels(instructions);
+	return true;
+}
+
+} /* namespace barcodes */
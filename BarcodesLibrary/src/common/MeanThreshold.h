@@ -0,0 +1,144 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       MeanThreshold.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines MeanThreshold class which implements adaptive mean
+//             threshold with SSE2/AVX2 kernels selected at runtime.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file MeanThreshold.h
+ *
+ * @brief Defines MeanThreshold class which implements adaptive mean
+ *        threshold with SSE2/AVX2 kernels selected at runtime.
+ * @author agent agent(at)local
+ */
+
+#ifndef MEANTHRESHOLD_H_
+#define MEANTHRESHOLD_H_
+
+#include <opencv2/core/core.hpp>
+
+namespace barcodes {
+using namespace cv;
+
+/**
+ * Adaptive mean threshold (box sums + fused mean and compare). Results are
+ * bit exact with the OpenCV's adaptiveThreshold with ADAPTIVE_THRESH_MEAN_C
+ * and THRESH_BINARY. Kernels are chosen by the CPU features on the first use,
+ * plain C++ kernels are used on the other platforms.
+ */
+class MeanThreshold {
+public:
+
+	/**
+	 * Plain C++ kernels.
+	 */
+	static const int INSTRUCTIONS_SCALAR = 0;
+
+	/**
+	 * SSE2 kernels.
+	 */
+	static const int INSTRUCTIONS_SSE2   = 1;
+
+	/**
+	 * AVX2 kernels.
+	 */
+	static const int INSTRUCTIONS_AVX2   = 2;
+
+	/**
+	 * Binarizes the image by adaptive mean threshold to values 0 and 255.
+	 * Box sums are calculated by separable running sums.
+	 *
+	 * pixel = ( pixel > mean - C ) ? 255 : 0
+	 *
+	 * @param image Grayscale image (CV_8UC1).
+	 * @param binarized Output binarized image.
+	 * @param blockSize Size of the block from which is calculated the mean (odd number).
+	 * @param mean_C Constant which offsets threshold value.
+	 * @param parallel Whether to binarize the horizontal bands of the image on the thread pool.
+	 */
+	static void threshold(const Mat &image, Mat &binarized, int blockSize, int mean_C, bool parallel = false);
+
+	/**
+	 * Calculates means of the image, result is the same as of the normalized
+	 * boxFilter with BORDER_REPLICATE. Box sums are calculated by separable running sums.
+	 *
+	 * @param image Grayscale image (CV_8UC1).
+	 * @param mean Output means.
+	 * @param blockSize Size of the block from which is calculated the mean (odd number).
+	 * @param parallel Whether to process the horizontal bands of the image on the thread pool.
+	 */
+	static void mean(const Mat &image, Mat &mean, int blockSize, bool parallel = false);
+
+	/**
+	 * Calculates the box sums of one row from the prefix sums of the block columns.
+	 * Columns outside the image are replicated from the border.
+	 *
+	 * @param colSums Prefix sums of the block columns (cols + 1 values, first is zero).
+	 * @param cols Number of the columns of the row.
+	 * @param blockSize Size of the block.
+	 * @param sums Output box sums (cols values).
+	 */
+	static void boxSums(const uint32_t *colSums, int cols, int blockSize, uint32_t *sums);
+
+	/**
+	 * Binarizes one row by the box sums of its pixels.
+	 *
+	 * @param src Pixels of the row.
+	 * @param sums Box sums of the pixels.
+	 * @param cols Number of the columns of the row.
+	 * @param blockSize Size of the block of the sums.
+	 * @param mean_C Constant which offsets threshold value.
+	 * @param dst Output binarized row.
+	 */
+	static void thresholdRow(const uchar *src, const uint32_t *sums, int cols, int blockSize, int mean_C, uchar *dst);
+
+	/**
+	 * Calculates means of one row from the box sums of its pixels.
+	 *
+	 * @param sums Box sums of the pixels.
+	 * @param cols Number of the columns of the row.
+	 * @param blockSize Size of the block of the sums.
+	 * @param dst Output means.
+	 */
+	static void meanRow(const uint32_t *sums, int cols, int blockSize, uchar *dst);
+
+	/**
+	 * Tests whether the box sums of the specified block size fits into 32 bits.
+	 *
+	 * @param blockSize Size of the block.
+	 * @return True if the kernels can be used for this block size.
+	 */
+	static bool isApplicable(int blockSize);
+
+	/**
+	 * Returns the instructions of the used kernels.
+	 *
+	 * @return Instructions of the used kernels.
+	 */
+	static int getInstructions();
+
+	/**
+	 * Tests whether the kernels with specified instructions are supported by the CPU.
+	 *
+	 * @param instructions Instructions of the kernels.
+	 * @return True if kernels are supported, otherwise false.
+	 */
+	static bool isSupported(int instructions);
+
+	/**
+	 * Sets the kernels which should be used. Not thread safe, it is intended
+	 * for testing of the kernels.
+	 *
+	 * @param instructions Instructions of the kernels.
+	 * @return True if kernels have been set, false if they are not supported.
+	 */
+	static bool setInstructions(int instructions);
+};
+
+} /* namespace barcodes */
+#endif /* MEANTHRESHOLD_H_ */
@@ -0,0 +1,165 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       ThreadPool.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of ThreadPool class which runs parallel loops
+//             of the library on the shared worker threads.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThreadPool.cpp
+ *
+ * @brief Defines members of ThreadPool class which runs parallel loops
+ *        of the library on the shared worker threads.
+ * @author agent agent(at)local
+ */
+
+#include <opencv2/core/core.hpp>
+
+#include "ThreadPool.h"
+
+namespace barcodes {
+
+/**
+ * Instance of the thread pool.
+ */
+ThreadPool *ThreadPool::POOL_INSTANCE = NULL;
+
+ThreadPool::ThreadPool(int threadsCount) {
+	pthread_mutex_init(&mutex, NULL);
+	pthread_cond_init(&jobAdded, NULL);
+	pthread_cond_init(&jobDone, NULL);
+
+	for (int i = 0; i < threadsCount; i++) {
+		pthread_t thread;
+		if (pthread_create(&thread, NULL, workerMain, this) != 0) break;
+		pthread_detach(thread);
+		threads.push_back(thread);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	pthread_cond_destroy(&jobDone);
+	pthread_cond_destroy(&jobAdded);
+	pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * Runs the loop in parallel and returns after all chunks are done.
+ *
+ * @param from First index of the loop.
+ * @param to Index after the last index of the loop.
+ * @param chunkSize Number of the indices of one chunk.
+ * @param task Body of the loop.
+ */
+void ThreadPool::parallelFor(int from, int to, int chunkSize, ParallelTask &task) {
+	if (from >= to) return;
+	if (chunkSize < 1) chunkSize = 1;
+
+	// Nothing to share, runs the loop in the calling thread
+	if ((threads.empty()) || (to - from <= chunkSize)) {
+		task.run(from, to);
+		return;
+	}
+
+	Job job;
+	job.task = &task;
+	job.next = from;
+	job.end = to;
+	job.chunkSize = chunkSize;
+	job.pending = (to - from + chunkSize - 1) / chunkSize;
+
+	pthread_mutex_lock(&mutex);
+	jobs.push_back(&job);
+	pthread_cond_broadcast(&jobAdded);
+
+	// Calling thread helps and then waits for the chunks claimed by the workers
+	while (job.next < job.end) {
+		runChunk(&job);
+	}
+	while (job.pending > 0) {
+		pthread_cond_wait(&jobDone, &mutex);
+	}
+
+	jobs.remove(&job);
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Returns number of the threads which can run the loops (including the calling thread).
+ *
+ * @return Number of the threads.
+ */
+int ThreadPool::getThreadsCount() const {
+	return threads.size() + 1;
+}
+
+/**
+ * Returns instance of the thread pool, threads are started on the first call.
+ *
+ * @return Instance of the thread pool.
+ */
+ThreadPool *ThreadPool::getInstance() {
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, createInstance);
+	return POOL_INSTANCE;
+}
+
+/**
+ * Claims next chunk of the job and runs it. Mutex has to be locked.
+ *
+ * @param job Job which chunk should be run.
+ */
+void ThreadPool::runChunk(Job *job) {
+	int from = job->next;
+	int to = (job->end - from > job->chunkSize)? from + job->chunkSize : job->end;
+	job->next = to;
+
+	pthread_mutex_unlock(&mutex);
+	job->task->run(from, to);
+	pthread_mutex_lock(&mutex);
+
+	if (--job->pending == 0) {
+		pthread_cond_broadcast(&jobDone);
+	}
+}
+
+/**
+ * Creates instance of the thread pool.
+ */
+void ThreadPool::createInstance() {
+	POOL_INSTANCE = new ThreadPool(cv::getNumberOfCPUs() - 1);
+}
+
+/**
+ * Main function of the worker threads.
+ *
+ * @param pool Thread pool of the worker.
+ */
+void *ThreadPool::workerMain(void *pool) {
+	ThreadPool *threadPool = (ThreadPool *)pool;
+
+	pthread_mutex_lock(&threadPool->mutex);
+	while (true) {
+		Job *job = NULL;
+		for (list<Job *>::iterator iter = threadPool->jobs.begin(); iter != threadPool->jobs.end(); ++iter) {
+			if ((*iter)->next < (*iter)->end) {
+				job = *iter;
+				break;
+			}
+		}
+
+		if (job == NULL) {
+			pthread_cond_wait(&threadPool->jobAdded, &threadPool->mutex);
+		} else {
+			threadPool->runChunk(job);
+		}
+	}
+
+	return NULL;
+}
+
+} /* namespace barcodes */
@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       ThreadPool.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines ThreadPool class which runs parallel loops of the
+//             library on the shared worker threads.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThreadPool.h
+ *
+ * @brief Defines ThreadPool class which runs parallel loops of the
+ *        library on the shared worker threads.
+ * @author agent agent(at)local
+ */
+
+#ifndef THREADPOOL_H_
+#define THREADPOOL_H_
+
+#include <list>
+#include <vector>
+#include <pthread.h>
+
+namespace barcodes {
+using namespace std;
+
+/**
+ * Body of the parallel loop. It must not throw any exception.
+ */
+class ParallelTask {
+public:
+	virtual ~ParallelTask() {}
+
+	/**
+	 * Runs one chunk of the loop.
+	 *
+	 * @param from First index of the chunk.
+	 * @param to Index after the last index of the chunk.
+	 */
+	virtual void run(int from, int to) = 0;
+};
+
+/**
+ * Singleton pool of the worker threads. Chunks of the loop are claimed
+ * dynamically by the workers and by the calling thread as well, so the
+ * parallel loops can be nested without blocking of the pool.
+ */
+class ThreadPool {
+public:
+
+	/**
+	 * Runs the loop in parallel and returns after all chunks are done.
+	 *
+	 * @param from First index of the loop.
+	 * @param to Index after the last index of the loop.
+	 * @param chunkSize Number of the indices of one chunk.
+	 * @param task Body of the loop.
+	 */
+	void parallelFor(int from, int to, int chunkSize, ParallelTask &task);
+
+	/**
+	 * Returns number of the threads which can run the loops (including the calling thread).
+	 *
+	 * @return Number of the threads.
+	 */
+	int getThreadsCount() const;
+
+	/**
+	 * Returns instance of the thread pool, threads are started on the first call.
+	 *
+	 * @return Instance of the thread pool.
+	 */
+	static ThreadPool *getInstance();
+protected:
+
+	/**
+	 * Parallel loop waiting for processing.
+	 */
+	struct Job {
+
+		/**
+		 * Body of the loop.
+		 */
+		ParallelTask *task;
+
+		/**
+		 * First index of the next unclaimed chunk.
+		 */
+		int next;
+
+		/**
+		 * Index after the last index of the loop.
+		 */
+		int end;
+
+		/**
+		 * Number of the indices of one chunk.
+		 */
+		int chunkSize;
+
+		/**
+		 * Number of the chunks which are not done yet.
+		 */
+		int pending;
+	};
+
+	/**
+	 * Instance of the thread pool.
+	 */
+	static ThreadPool *POOL_INSTANCE;
+
+	/**
+	 * Loops which have not been finished yet.
+	 */
+	list<Job *> jobs;
+
+	/**
+	 * Worker threads.
+	 */
+	vector<pthread_t> threads;
+
+	/**
+	 * Mutex guarding the jobs.
+	 */
+	pthread_mutex_t mutex;
+
+	/**
+	 * Condition signaled when new job has been added.
+	 */
+	pthread_cond_t jobAdded;
+
+	/**
+	 * Condition signaled when some job has been done.
+	 */
+	pthread_cond_t jobDone;
+
+	ThreadPool(int threadsCount);
+	virtual ~ThreadPool();
+
+	/**
+	 * Claims next chunk of the job and runs it. Mutex has to be locked.
+	 *
+	 * @param job Job which chunk should be run.
+	 */
+	void runChunk(Job *job);
+
+	/**
+	 * Creates instance of the thread pool.
+	 */
+	static void createInstance();
+
+	/**
+	 * Main function of the worker threads.
+	 *
+	 * @param pool Thread pool of the worker.
+	 */
+	static void *workerMain(void *pool);
+};
+
+} /* namespace barcodes */
+#endif /* THREADPOOL_H_ */
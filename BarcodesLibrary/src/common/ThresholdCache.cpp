@@ -0,0 +1,372 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       ThresholdCache.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines members of ThresholdCache class which computes adaptive
+//             mean thresholds of one image for any block size from one
+//             integral image and keeps the results for later use.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThresholdCache.cpp
+ *
+ * @brief Defines members of ThresholdCache class which computes adaptive
+ *        mean thresholds of one image for any block size from one
+ *        integral image and keeps the results for later use.
+ * @author agent agent(at)local
+ */
+
+#include <cstring>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include "ThresholdCache.h"
+#include "MeanThreshold.h"
+#include "ThreadPool.h"
+
+namespace barcodes {
+
+/**
+ * Creates the cache for the specified image.
+ *
+ * @param image Grayscale image (CV_8UC1) which will be binarized.
+ * @param parallel Whether to process the bands of the image on the thread pool.
+ */
+ThresholdCache::ThresholdCache(const Mat &image, bool parallel) : image(image), parallel(parallel) {
+	pthread_mutex_init(&mutex, NULL);
+}
+
+ThresholdCache::~ThresholdCache() {
+	pthread_mutex_destroy(&mutex);
+}
+
+/**
+ * Returns the image for which this cache has been created.
+ *
+ * @return Image of this cache.
+ */
+const Mat &ThresholdCache::getImage() const {
+	return image;
+}
+
+/**
+ * Returns whether the bands of the image are processed on the thread pool.
+ *
+ * @return True if the image is processed in parallel.
+ */
+bool ThresholdCache::isParallel() const {
+	return parallel;
+}
+
+/**
+ * Returns the image binarized by adaptive mean threshold to values 0 and 255.
+ *
+ * pixel = ( pixel > mean - C ) ? 255 : 0
+ *
+ * @param blockSize Size of the block from which is calculated the mean (odd number).
+ * @param mean_C Constant which offsets threshold value.
+ * @return Binarized image.
+ */
+const Mat &ThresholdCache::adaptiveThreshold(int blockSize, int mean_C) {
+	pair<int, int> key(blockSize, mean_C);
+
+	pthread_mutex_lock(&mutex);
+	map<pair<int, int>, Mat>::iterator iter = thresholds.find(key);
+	bool found = iter != thresholds.end();
+	pthread_mutex_unlock(&mutex);
+	if (found) {
+		return iter->second;
+	}
+
+	// Calculated outside the lock, so the other block sizes can be calculated concurrently
+	Mat binarized;
+	if (!MeanThreshold::isApplicable(blockSize)) {
+
+		// Too large blocks would overflow 32-bit sums, let OpenCV handle them
+		cv::adaptiveThreshold(image, binarized, 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY, blockSize, mean_C);
+	} else {
+		binarized.create(image.rows, image.cols, CV_8UC1);
+		if (!binarized.empty()) {
+			buildIntegralImage();
+			processRows(blockSize, mean_C, true, binarized);
+		}
+	}
+
+	// The first stored result wins if the same threshold has been calculated concurrently
+	pthread_mutex_lock(&mutex);
+	iter = thresholds.insert(make_pair(key, binarized)).first;
+	pthread_mutex_unlock(&mutex);
+
+	return iter->second;
+}
+
+/**
+ * Returns means of the image calculated for the specified block size.
+ * Result is the same as of the normalized boxFilter with BORDER_REPLICATE.
+ *
+ * @param blockSize Size of the block from which is calculated the mean (odd number).
+ * @return Matrix of the means.
+ */
+const Mat &ThresholdCache::mean(int blockSize) {
+	pthread_mutex_lock(&mutex);
+	map<int, Mat>::iterator iter = means.find(blockSize);
+	bool found = iter != means.end();
+	pthread_mutex_unlock(&mutex);
+	if (found) {
+		return iter->second;
+	}
+
+	Mat mean;
+	if (!MeanThreshold::isApplicable(blockSize)) {
+		boxFilter(image, mean, image.type(), Size(blockSize, blockSize), Point(-1,-1), true, BORDER_REPLICATE);
+	} else {
+		mean.create(image.rows, image.cols, CV_8UC1);
+		if (!mean.empty()) {
+			buildIntegralImage();
+			processRows(blockSize, 0, false, mean);
+		}
+	}
+
+	pthread_mutex_lock(&mutex);
+	iter = means.insert(make_pair(blockSize, mean)).first;
+	pthread_mutex_unlock(&mutex);
+
+	return iter->second;
+}
+
+/**
+ * Returns binarized image which has been derived from the thresholds
+ * of this cache (e.g. repaired or globally thresholded) and stored before.
+ *
+ * @param blockSize Size of the block of the source threshold (0 if not adaptive).
+ * @param mean_C Constant of the source threshold.
+ * @param variant Variant of the derived image, defined by the user of the cache.
+ * @param binarized Stored binarized image.
+ * @return True if the binarized image has been found, otherwise false.
+ */
+bool ThresholdCache::getBinarized(int blockSize, int mean_C, int variant, Mat &binarized) const {
+	bool found = false;
+
+	pthread_mutex_lock(&mutex);
+	map<pair<pair<int, int>, int>, Mat>::const_iterator iter = binarizations.find(
+			make_pair(make_pair(blockSize, mean_C), variant));
+	if (iter != binarizations.end()) {
+		binarized = iter->second;
+		found = true;
+	}
+	pthread_mutex_unlock(&mutex);
+
+	return found;
+}
+
+/**
+ * Stores binarized image which has been derived from the thresholds
+ * of this cache (e.g. repaired or globally thresholded).
+ *
+ * @param blockSize Size of the block of the source threshold (0 if not adaptive).
+ * @param mean_C Constant of the source threshold.
+ * @param variant Variant of the derived image, defined by the user of the cache.
+ * @param binarized Binarized image to be stored.
+ */
+void ThresholdCache::setBinarized(int blockSize, int mean_C, int variant, const Mat &binarized) {
+	pthread_mutex_lock(&mutex);
+	binarizations[make_pair(make_pair(blockSize, mean_C), variant)] = binarized;
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Releases all cached matrices including the integral image.
+ */
+void ThresholdCache::clear() {
+	pthread_mutex_lock(&mutex);
+	integralImage.release();
+	thresholds.clear();
+	means.clear();
+	binarizations.clear();
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Parallel task which runs one pass of the cache above the rows or columns.
+ */
+class ThresholdCache::RowsTask : public ParallelTask {
+public:
+	static const int PASS_INTEGRAL_ROWS    = 0;
+	static const int PASS_INTEGRAL_COLUMNS = 1;
+	static const int PASS_THRESHOLD        = 2;
+	static const int PASS_MEAN             = 3;
+
+	RowsTask(ThresholdCache &cache, int pass, int blockSize = 0, int mean_C = 0, Mat *dst = NULL) :
+		cache(cache), pass(pass), blockSize(blockSize), mean_C(mean_C), dst(dst) {}
+
+	void run(int from, int to) {
+		switch (pass) {
+			case PASS_INTEGRAL_ROWS: cache.integralRows(from, to); break;
+			case PASS_INTEGRAL_COLUMNS: cache.integralColumns(from, to); break;
+			default: cache.processRows(from, to, blockSize, mean_C, pass == PASS_THRESHOLD, *dst); break;
+		}
+	}
+protected:
+	ThresholdCache &cache;
+	int pass;
+	int blockSize;
+	int mean_C;
+	Mat *dst;
+};
+
+/**
+ * Builds the integral image if has not been built yet.
+ */
+void ThresholdCache::buildIntegralImage() {
+	pthread_mutex_lock(&mutex);
+	if (integralImage.data != NULL) {
+		pthread_mutex_unlock(&mutex);
+		return;
+	}
+
+	integralImage.create(image.rows + 1, image.cols + 1, CV_32SC1);
+	memset(integralImage.ptr<uint32_t>(0), 0, integralImage.cols * sizeof(uint32_t));
+
+	if (parallel) {
+		// Row prefix sums are independent, then the columns are summed by the stripes
+		ThreadPool *threadPool = ThreadPool::getInstance();
+		RowsTask rowsTask(*this, RowsTask::PASS_INTEGRAL_ROWS);
+		RowsTask columnsTask(*this, RowsTask::PASS_INTEGRAL_COLUMNS);
+		threadPool->parallelFor(0, image.rows, getRowsChunk(), rowsTask);
+		threadPool->parallelFor(0, integralImage.cols, INTEGRAL_COLUMNS_CHUNK, columnsTask);
+	} else {
+		integralRows(0, image.rows);
+		integralColumns(0, integralImage.cols);
+	}
+	pthread_mutex_unlock(&mutex);
+}
+
+/**
+ * Stores the prefix sums of the image rows into the integral image.
+ *
+ * @param from First row of the image.
+ * @param to Row after the last row of the image.
+ */
+void ThresholdCache::integralRows(int from, int to) {
+	for (int row = from; row < to; row++) {
+		const uchar *src = image.ptr<uchar>(row);
+		uint32_t *dst = integralImage.ptr<uint32_t>(row + 1);
+		uint32_t rowSum = 0;
+
+		dst[0] = 0;
+		for (int col = 0; col < image.cols; col++) {
+			rowSum += src[col];
+			dst[col + 1] = rowSum;
+		}
+	}
+}
+
+/**
+ * Sums the row prefix sums of the integral image in the columns.
+ *
+ * @param from First column of the integral image.
+ * @param to Column after the last column of the integral image.
+ */
+void ThresholdCache::integralColumns(int from, int to) {
+	for (int row = 1; row <= image.rows; row++) {
+		const uint32_t *prev = integralImage.ptr<uint32_t>(row - 1);
+		uint32_t *curr = integralImage.ptr<uint32_t>(row);
+
+		for (int col = from; col < to; col++) {
+			curr[col] += prev[col];
+		}
+	}
+}
+
+/**
+ * Thresholds or calculates means of the whole image from the integral image.
+ *
+ * @param blockSize Size of the block.
+ * @param mean_C Constant which offsets threshold value.
+ * @param threshold Whether to threshold the image or to calculate the means.
+ * @param dst Output image.
+ */
+void ThresholdCache::processRows(int blockSize, int mean_C, bool threshold, Mat &dst) {
+	if (parallel) {
+		RowsTask task(*this, (threshold)? RowsTask::PASS_THRESHOLD : RowsTask::PASS_MEAN, blockSize, mean_C, &dst);
+		ThreadPool::getInstance()->parallelFor(0, image.rows, getRowsChunk(), task);
+	} else {
+		processRows(0, image.rows, blockSize, mean_C, threshold, dst);
+	}
+}
+
+/**
+ * Thresholds or calculates means of the rows from the integral image.
+ * Rows of the integral image up to block size / 2 above and below
+ * the processed rows are used.
+ *
+ * @param from First row of the image.
+ * @param to Row after the last row of the image.
+ * @param blockSize Size of the block.
+ * @param mean_C Constant which offsets threshold value.
+ * @param threshold Whether to threshold the rows or to calculate the means.
+ * @param dst Output image.
+ */
+void ThresholdCache::processRows(int from, int to, int blockSize, int mean_C, bool threshold, Mat &dst) const {
+	vector<uint32_t> colSums(image.cols + 1);
+	vector<uint32_t> sums(image.cols);
+
+	for (int row = from; row < to; row++) {
+		rowBoxSums(row, blockSize, &colSums[0], &sums[0]);
+		if (threshold) {
+			MeanThreshold::thresholdRow(image.ptr<uchar>(row), &sums[0], image.cols, blockSize, mean_C, dst.ptr<uchar>(row));
+		} else {
+			MeanThreshold::meanRow(&sums[0], image.cols, blockSize, dst.ptr<uchar>(row));
+		}
+	}
+}
+
+/**
+ * Returns number of the rows of one parallel chunk.
+ *
+ * @return Number of the rows of one chunk.
+ */
+int ThresholdCache::getRowsChunk() const {
+	int chunks = ThreadPool::getInstance()->getThreadsCount() * CHUNKS_PER_THREAD;
+	return max((image.rows + chunks - 1) / chunks, 1);
+}
+
+/**
+ * Calculates the sums of the block for each pixel of one row.
+ * Pixels outside the image are replicated from the border.
+ *
+ * @param row Row for which should be calculated the sums.
+ * @param blockSize Size of the block.
+ * @param colSums Temporary buffer for the prefix sums of the block columns (cols + 1).
+ * @param sums Output sums of the blocks for each pixel of the row (cols).
+ */
+void ThresholdCache::rowBoxSums(int row, int blockSize, uint32_t *colSums, uint32_t *sums) const {
+	int radius = blockSize / 2;
+	int rows = image.rows;
+	int cols = image.cols;
+
+	// Rows of the block inside image and count of the replicated border rows
+	int rowFrom = max(row - radius, 0);
+	int rowTo = min(row + radius, rows - 1);
+	uint32_t topBorder = rowFrom - (row - radius);
+	uint32_t bottomBorder = (row + radius) - rowTo;
+
+	const uint32_t *top = integralImage.ptr<uint32_t>(rowFrom);
+	const uint32_t *bottom = integralImage.ptr<uint32_t>(rowTo + 1);
+	const uint32_t *first0 = integralImage.ptr<uint32_t>(0);
+	const uint32_t *first1 = integralImage.ptr<uint32_t>(1);
+	const uint32_t *last0 = integralImage.ptr<uint32_t>(rows - 1);
+	const uint32_t *last1 = integralImage.ptr<uint32_t>(rows);
+
+	// Prefix sums of the block columns, replicated rows are added as multiples of border rows
+	for (int col = 0; col <= cols; col++) {
+		colSums[col] = (bottom[col] - top[col]) + topBorder * (first1[col] - first0[col])
+				+ bottomBorder * (last1[col] - last0[col]);
+	}
+
+	MeanThreshold::boxSums(colSums, cols, blockSize, sums);
+}
+
+} /* namespace barcodes */
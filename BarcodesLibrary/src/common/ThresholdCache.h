@@ -0,0 +1,230 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       ThresholdCache.h
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Defines ThresholdCache class which computes adaptive mean
+//             thresholds of one image for any block size from one integral
+//             image and keeps the results for later use.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file ThresholdCache.h
+ *
+ * @brief Defines ThresholdCache class which computes adaptive mean
+ *        thresholds of one image for any block size from one integral
+ *        image and keeps the results for later use.
+ * @author agent agent(at)local
+ */
+
+#ifndef THRESHOLDCACHE_H_
+#define THRESHOLDCACHE_H_
+
+#include <map>
+#include <pthread.h>
+#include <opencv2/core/core.hpp>
+
+namespace barcodes {
+using namespace std;
+using namespace cv;
+
+/**
+ * Binarization engine of one frame. The integral image of the frame is built
+ * only once and every block size demanded later is calculated from it.
+ * Results are the same as results of the OpenCV's adaptiveThreshold with
+ * ADAPTIVE_THRESH_MEAN_C and THRESH_BINARY (box filter with BORDER_REPLICATE).
+ *
+ * Returned matrices share the data with the cache, so they must not be modified.
+ * The cache can be used from more threads at once, only clear must not be called
+ * while the other threads use the cache.
+ */
+class ThresholdCache {
+public:
+	/**
+	 * Creates the cache for the specified image.
+	 *
+	 * @param image Grayscale image (CV_8UC1) which will be binarized.
+	 * @param parallel Whether to process the bands of the image on the thread pool.
+	 */
+	ThresholdCache(const Mat &image, bool parallel = false);
+	virtual ~ThresholdCache();
+
+	/**
+	 * Returns the image for which this cache has been created.
+	 *
+	 * @return Image of this cache.
+	 */
+	const Mat &getImage() const;
+
+	/**
+	 * Returns whether the bands of the image are processed on the thread pool.
+	 *
+	 * @return True if the image is processed in parallel.
+	 */
+	bool isParallel() const;
+
+	/**
+	 * Returns the image binarized by adaptive mean threshold to values 0 and 255.
+	 *
+	 * pixel = ( pixel > mean - C ) ? 255 : 0
+	 *
+	 * @param blockSize Size of the block from which is calculated the mean (odd number).
+	 * @param mean_C Constant which offsets threshold value.
+	 * @return Binarized image.
+	 */
+	const Mat &adaptiveThreshold(int blockSize, int mean_C);
+
+	/**
+	 * Returns means of the image calculated for the specified block size.
+	 * Result is the same as of the normalized boxFilter with BORDER_REPLICATE.
+	 *
+	 * @param blockSize Size of the block from which is calculated the mean (odd number).
+	 * @return Matrix of the means.
+	 */
+	const Mat &mean(int blockSize);
+
+	/**
+	 * Returns binarized image which has been derived from the thresholds
+	 * of this cache (e.g. repaired or globally thresholded) and stored before.
+	 *
+	 * @param blockSize Size of the block of the source threshold (0 if not adaptive).
+	 * @param mean_C Constant of the source threshold.
+	 * @param variant Variant of the derived image, defined by the user of the cache.
+	 * @param binarized Stored binarized image.
+	 * @return True if the binarized image has been found, otherwise false.
+	 */
+	bool getBinarized(int blockSize, int mean_C, int variant, Mat &binarized) const;
+
+	/**
+	 * Stores binarized image which has been derived from the thresholds
+	 * of this cache (e.g. repaired or globally thresholded).
+	 *
+	 * @param blockSize Size of the block of the source threshold (0 if not adaptive).
+	 * @param mean_C Constant of the source threshold.
+	 * @param variant Variant of the derived image, defined by the user of the cache.
+	 * @param binarized Binarized image to be stored.
+	 */
+	void setBinarized(int blockSize, int mean_C, int variant, const Mat &binarized);
+
+	/**
+	 * Releases all cached matrices including the integral image.
+	 */
+	void clear();
+protected:
+	class RowsTask;
+	friend class RowsTask;
+
+	/**
+	 * Number of the parallel chunks per one thread (balances the load of the threads).
+	 */
+	static const int CHUNKS_PER_THREAD      = 4;
+
+	/**
+	 * Number of the columns of one parallel chunk when summing the integral image.
+	 */
+	static const int INTEGRAL_COLUMNS_CHUNK = 256;
+
+	/**
+	 * Image which is binarized.
+	 */
+	Mat image;
+
+	/**
+	 * Whether to process the bands of the image on the thread pool.
+	 */
+	bool parallel;
+
+	/**
+	 * Integral image of the image. Sums are stored as unsigned 32-bit values
+	 * and are allowed to overflow, because only the differences are used.
+	 */
+	Mat integralImage;
+
+	/**
+	 * Already calculated thresholds, key is the pair of block size and C constant.
+	 */
+	map<pair<int, int>, Mat> thresholds;
+
+	/**
+	 * Already calculated means, key is the block size.
+	 */
+	map<int, Mat> means;
+
+	/**
+	 * Stored derived binarized images, key is the pair of the source threshold key and variant.
+	 */
+	map<pair<pair<int, int>, int>, Mat> binarizations;
+
+	/**
+	 * Mutex guarding the cached matrices and building of the integral image.
+	 */
+	mutable pthread_mutex_t mutex;
+
+	/**
+	 * Builds the integral image if has not been built yet.
+	 */
+	void buildIntegralImage();
+
+	/**
+	 * Stores the prefix sums of the image rows into the integral image.
+	 *
+	 * @param from First row of the image.
+	 * @param to Row after the last row of the image.
+	 */
+	void integralRows(int from, int to);
+
+	/**
+	 * Sums the row prefix sums of the integral image in the columns.
+	 *
+	 * @param from First column of the integral image.
+	 * @param to Column after the last column of the integral image.
+	 */
+	void integralColumns(int from, int to);
+
+	/**
+	 * Thresholds or calculates means of the whole image from the integral image.
+	 *
+	 * @param blockSize Size of the block.
+	 * @param mean_C Constant which offsets threshold value.
+	 * @param threshold Whether to threshold the image or to calculate the means.
+	 * @param dst Output image.
+	 */
+	void processRows(int blockSize, int mean_C, bool threshold, Mat &dst);
+
+	/**
+	 * Thresholds or calculates means of the rows from the integral image.
+	 * Rows of the integral image up to block size / 2 above and below
+	 * the processed rows are used.
+	 *
+	 * @param from First row of the image.
+	 * @param to Row after the last row of the image.
+	 * @param blockSize Size of the block.
+	 * @param mean_C Constant which offsets threshold value.
+	 * @param threshold Whether to threshold the rows or to calculate the means.
+	 * @param dst Output image.
+	 */
+	void processRows(int from, int to, int blockSize, int mean_C, bool threshold, Mat &dst) const;
+
+	/**
+	 * Returns number of the rows of one parallel chunk.
+	 *
+	 * @return Number of the rows of one chunk.
+	 */
+	int getRowsChunk() const;
+
+	/**
+	 * Calculates the sums of the block for each pixel of one row.
+	 * Pixels outside the image are replicated from the border.
+	 *
+	 * @param row Row for which should be calculated the sums.
+	 * @param blockSize Size of the block.
+	 * @param colSums Temporary buffer for the prefix sums of the block columns (cols + 1).
+	 * @param sums Output sums of the blocks for each pixel of the row (cols).
+	 */
+	void rowBoxSums(int row, int blockSize, uint32_t *colSums, uint32_t *sums) const;
+};
+
+} /* namespace barcodes */
+#endif /* THRESHOLDCACHE_H_ */
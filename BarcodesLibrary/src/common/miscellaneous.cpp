@@ -17,11 +17,19 @@
  * @author Radim Loskot xlosko01(at)stud.fit.vutbr.cz
  */
 
+#include <cstring>
 #include <opencv2/imgproc/imgproc.hpp>
 #include "miscellaneous.h"
+#include "MeanThreshold.h"
+#include "ThreadPool.h"
 
 namespace barcodes {
 
+/**
+ * Number of the parallel chunks per one thread used by the fill repair.
+ */
+static const int FILL_MISSING_CHUNKS_PER_THREAD = 4;
+
 /**
  * Finds match inside an image.
  *
@@ -68,17 +76,27 @@ double matchTemplate(Mat img, Mat imgTemplate, int match_method, Point &matchLoc
  * @return Transformation matrix for perspective transformation.
  */
 Mat getPerspectiveTransform(vector<Point> &corners, Size resultSize) {
+	vector<Point2f> corners2f;
+	Mat(corners).convertTo(corners2f, CV_32F);
+	return getPerspectiveTransform(corners2f, resultSize);
+}
+
+/**
+ * Returns transformation matrix for perspective transformation.
+ * Corners are in the subpixel precision.
+ *
+ * @param corners Four points of the perspective projection, should be ordered from top right and clockwise.
+ * @param resultSize Result size for transformation.
+ * @return Transformation matrix for perspective transformation.
+ */
+Mat getPerspectiveTransform(vector<Point2f> &corners, Size resultSize) {
 	Point2f srcPoints[4], dstPoints[4];
 
 	// Coordinates in the perspective
-	srcPoints[0].x = corners.at(3).x; // left up
-	srcPoints[0].y = corners.at(3).y;
-	srcPoints[1].x = corners.at(0).x; // right up
-	srcPoints[1].y = corners.at(0).y;
-	srcPoints[2].x = corners.at(2).x; // left bottom
-	srcPoints[2].y = corners.at(2).y;
-	srcPoints[3].x = corners.at(1).x; // right bottom
-	srcPoints[3].y = corners.at(1).y;
+	srcPoints[0] = corners.at(3); // left up
+	srcPoints[1] = corners.at(0); // right up
+	srcPoints[2] = corners.at(2); // left bottom
+	srcPoints[3] = corners.at(1); // right bottom
 
 	// Output warped coordinates
 	dstPoints[0].x = 0;
@@ -101,27 +119,34 @@ Mat getPerspectiveTransform(vector<Point> &corners, Size resultSize) {
  * @return Transformation matrix for perspective transformation.
  */
 Mat getPerspectiveTransform(vector<Point> &srcCorners, vector<Point> &dstCorners) {
+	vector<Point2f> srcCorners2f, dstCorners2f;
+	Mat(srcCorners).convertTo(srcCorners2f, CV_32F);
+	Mat(dstCorners).convertTo(dstCorners2f, CV_32F);
+	return getPerspectiveTransform(srcCorners2f, dstCorners2f);
+}
+
+/**
+ * Returns transformation matrix for perspective transformation.
+ * Corners are in the subpixel precision.
+ *
+ * @param srcCorners Four points of the source projection, should be ordered from top right and clockwise.
+ * @param dstCorners Four points of the destination projection, should be ordered from top right and clockwise.
+ * @return Transformation matrix for perspective transformation.
+ */
+Mat getPerspectiveTransform(vector<Point2f> &srcCorners, vector<Point2f> &dstCorners) {
 	Point2f srcPoints[4], dstPoints[4];
 
 	// Coordinates in the perspective
-	srcPoints[0].x = srcCorners.at(3).x; // left up
-	srcPoints[0].y = srcCorners.at(3).y;
-	srcPoints[1].x = srcCorners.at(0).x; // right up
-	srcPoints[1].y = srcCorners.at(0).y;
-	srcPoints[2].x = srcCorners.at(2).x; // left bottom
-	srcPoints[2].y = srcCorners.at(2).y;
-	srcPoints[3].x = srcCorners.at(1).x; // right bottom
-	srcPoints[3].y = srcCorners.at(1).y;
+	srcPoints[0] = srcCorners.at(3); // left up
+	srcPoints[1] = srcCorners.at(0); // right up
+	srcPoints[2] = srcCorners.at(2); // left bottom
+	srcPoints[3] = srcCorners.at(1); // right bottom
 
 	// Output warped coordinates
-	dstPoints[0].x = dstCorners.at(3).x; // left up
-	dstPoints[0].y = dstCorners.at(3).y;
-	dstPoints[1].x = dstCorners.at(0).x; // right up
-	dstPoints[1].y = dstCorners.at(0).y;
-	dstPoints[2].x = dstCorners.at(2).x; // left bottom
-	dstPoints[2].y = dstCorners.at(2).y;
-	dstPoints[3].x = dstCorners.at(1).x; // right bottom
-	dstPoints[3].y = dstCorners.at(1).y;
+	dstPoints[0] = dstCorners.at(3); // left up
+	dstPoints[1] = dstCorners.at(0); // right up
+	dstPoints[2] = dstCorners.at(2); // left bottom
+	dstPoints[3] = dstCorners.at(1); // right bottom
 
 	return cv::getPerspectiveTransform(srcPoints, dstPoints);
 }
@@ -138,13 +163,30 @@ Mat getPerspectiveTransform(vector<Point> &srcCorners, vector<Point> &dstCorners
  * @return Warped image.
  */
 Mat warpPerspective(Mat &image, vector<Point> &corners, bool sortCorners, Size resultSize) {
+	vector<Point2f> corners2f;
+	Mat(corners).convertTo(corners2f, CV_32F);
+	return warpPerspective(image, corners2f, sortCorners, resultSize);
+}
+
+/**
+ * Applies perspective transformation. Corners are in the subpixel precision.
+ *
+ * @param image Image to be transformed.
+ * @param corners Four points of the perspective projection, should be
+ *                ordered from top right and clockwise.
+ * @param sortCorners If points are not ordered, it can be done by
+ *        specifying true here. The result image but miggt be rotated then.
+ * @param resultSize Result size for transformation.
+ * @return Warped image.
+ */
+Mat warpPerspective(Mat &image, vector<Point2f> &corners, bool sortCorners, Size resultSize) {
 	Mat transformation;
 	Mat dstImage;
 
 	if (corners.size() > 3) {
 
 		// Sorting corners if needed.
-		vector<Point> sortedCorners;
+		vector<Point2f> sortedCorners;
 		if (sortCorners) {
 			convexHull(Mat(corners), sortedCorners);
 		} else {
@@ -182,6 +224,45 @@ double exactMatch(Mat &mat, Mat &tmpl, Mat &diff) {
     return countNonZero(diff) / (double)(mat.rows * mat.cols);
 }
 
+/**
+ * Packs the binarized image (0 and 255 values) to one bit per pixel,
+ * every row is packed into one 64-bit word (at most 64 columns).
+ *
+ * @param image Binarized image.
+ * @param packed Output packed rows.
+ */
+void packBinarized(const Mat &image, vector<uint64_t> &packed) {
+	CV_Assert((image.type() == CV_8UC1) && (image.cols <= 64));
+	packed.resize(image.rows);
+
+	for (int i = 0; i < image.rows; i++) {
+		const uchar *row = image.ptr<uchar>(i);
+		uint64_t bits = 0;
+		for (int j = 0; j < image.cols; j++) {
+			bits |= (uint64_t)(row[j] != 0) << j;
+		}
+		packed[i] = bits;
+	}
+}
+
+/**
+ * Matches two packed binarized images for exact match.
+ *
+ * @param packed Packed image against which should be done template match.
+ * @param packedTmpl Packed template used for matching.
+ * @param cols Number of the columns of the packed images.
+ * @return The ratio of the different pixels.
+ */
+double exactMatchPacked(const vector<uint64_t> &packed, const vector<uint64_t> &packedTmpl, int cols) {
+	CV_Assert(packed.size() == packedTmpl.size());
+
+	int different = 0;
+	for (unsigned int i = 0; i < packed.size(); i++) {
+		different += __builtin_popcountll(packed[i] ^ packedTmpl[i]);
+	}
+	return different / (double)(packed.size() * cols);
+}
+
 /**
  * Calculates histogram for image which is binarized to values 0 and 255.
  *
@@ -199,6 +280,59 @@ void calcBinarizedHistogram(Mat &image, Mat &contourMask, MatND &hist) {
 	calcHist(&image, 1, channels, contourMask, hist, 1, histSize, ranges);
 }
 
+/**
+ * Returns the shift which divides the number of row segments (rowCuts + 1),
+ * if this number is power of two.
+ *
+ * @param rowCuts The number of samples.
+ * @return Shift of the division or -1 if the number is not power of two.
+ */
+static int rowCutsShift(int rowCuts) {
+	int segments = rowCuts + 1;
+	if ((segments <= 0) || ((segments & (segments - 1)) != 0)) {
+		return -1;
+	}
+
+	int shift = 0;
+	while ((1 << shift) < segments) shift++;
+	return shift;
+}
+
+/**
+ * Calculates average mean on the row in specified column ranges.
+ * Arguments are supposed to be valid.
+ *
+ * @param means Means of the row.
+ * @param from Column where sampling starts.
+ * @param to Column where sampling ends.
+ * @param rowCuts The number of samples which from which is calculated average mean.
+ * @param shift Shift which divides the number of row segments or -1.
+ * @return Average mean.
+ *
+ * @see rowCutsShift
+ */
+static inline uchar _rowMeanAvg(const uchar *means, int from, int to, int rowCuts, int shift) {
+	if (rowCuts <= 0) {
+		return 0;
+	}
+
+	int sum = 0;
+	if (shift >= 0) {
+		// Division by power of two is exact in the floating point, integer shift samples the same columns
+		int length = to - from;
+		for (int i = 1; i < rowCuts + 1; i++) {
+			sum += means[from + ((length * i) >> shift)];
+		}
+	} else {
+		for (int i = 1; i < rowCuts + 1; i++) {
+			int col = from + ((to - from) / (double)(rowCuts + 1)) * i;
+			sum += means[col];
+		}
+	}
+
+	return sum / rowCuts;
+}
+
 /**
  * Calculates average mean on the row in specified column ranges.
  * Average is determined from samples of the row. Number of
@@ -216,76 +350,138 @@ uchar rowMeanAvg(Mat &means, int row, int from, int to, int rowCuts) {
 		return 0;
 	}
 
-	int col, sum = 0;
-	for (int i = 1; i < rowCuts + 1; i++) {
-		col = from + ((to - from) / (double)(rowCuts + 1)) * i;
-		sum +=  means.at<uchar>(row, col);
-	}
-
-	return sum / rowCuts;
-
+	return _rowMeanAvg(means.ptr<uchar>(row), from, to, rowCuts, rowCutsShift(rowCuts));
 }
 
 /**
- * Repairs blank places inside image which might occur after adaptive threshold.
+ * Repairs blank places inside the rows of the image.
  *
  * @param image Image after adaptive threshold.
- * @param refImage Reference image used for repair. It is image before adaptive threshold.
- * @param image_EdgeDetect_MeanBlockSize Block size of the adaptive threshold which
- *        will be used for determining edges (places where changes 0 to 1 or 1 to 0)
- * @param refImage_MeanBlockSize The block size that is used for calculation of means from reference image.
+ * @param means Means of the image after adaptive threshold.
+ * @param refMeans Means of the reference image.
+ * @param refImage_MeanBlockSize The block size that was used for calculation of means from reference image.
  * @param image_EdgeDetect_Mean_C The transition tolerance for edges (0 to 1 or 1 to 0).
  * @param rowCuts The number of samples which from which is calculated average mean on the row.
- *
- * @see rowMeanAvg
+ * @param from First row to be repaired.
+ * @param to Row after the last row to be repaired.
  */
-void fillMissing(Mat &image, Mat &refImage, int image_EdgeDetect_MeanBlockSize, int refImage_MeanBlockSize, int image_EdgeDetect_Mean_C, int rowCuts) {
-	int col;
-	int row;
+static void fillMissingRows(Mat &image, const Mat &means, const Mat &refMeans, int refImage_MeanBlockSize,
+		int image_EdgeDetect_Mean_C, int rowCuts, int from, int to) {
 	int cols = image.cols;
-	int rows = image.rows;
-	Mat mean;
-	Mat ref_mean;
+	int shift = rowCutsShift(rowCuts);
+	int bgThreshold = 128 - image_EdgeDetect_Mean_C;
 
-	// Calculating the means for edge detect
-    boxFilter( image, mean, image.type(), Size(image_EdgeDetect_MeanBlockSize, image_EdgeDetect_MeanBlockSize),
-               Point(-1,-1), true, BORDER_REPLICATE );
-
-    // Calculating means for fill and background determination
-    boxFilter( refImage, ref_mean, refImage.type(), Size(refImage_MeanBlockSize, refImage_MeanBlockSize),
-               Point(-1,-1), true, BORDER_REPLICATE );
-
-	for( row = 0; row < rows; row++ ) {
+	for (int row = from; row < to; row++) {
 	    uchar *icol = image.ptr<uchar>(row);
-	    uchar *mcol = mean.ptr<uchar>(row);
+	    const uchar *mcol = means.ptr<uchar>(row);
+	    const uchar *rcol = refMeans.ptr<uchar>(row);
 
 	    // As background are supposed to be values near to the 255
-	    bool isBackground = *mcol >= 128 - image_EdgeDetect_Mean_C;
+	    bool isBackground = mcol[0] >= bgThreshold;
 	    int bgBegin = -1;
 	    int bgEnd = -1;
 
-	    for(col = 0 ; col < cols; icol++, mcol++, col++ ) {
+	    for (int col = 0; col < cols; col++) {
+	    	bool isColBackground = mcol[col] >= bgThreshold;
+	    	if (isColBackground == isBackground) continue;
+
 	    	// Background ends here - 255 => 0
-	    	if (*mcol < 128 - image_EdgeDetect_Mean_C && isBackground) {
+	    	if (isBackground) {
 	    		bgEnd = col;
 	    	// Fill ends here - 0 => 255
-	    	} else if (*mcol >= 128 - image_EdgeDetect_Mean_C && !isBackground) {
+	    	} else {
 	    		if (bgBegin != -1) { // For filling area we need to know start of the background
-					uchar bgMeanAvgCenter = rowMeanAvg(ref_mean, row, bgBegin, bgEnd, rowCuts);
-					uchar fillMeanAvgCenter = rowMeanAvg(ref_mean, row, bgEnd, col, rowCuts);
+					uchar bgMeanAvgCenter = _rowMeanAvg(rcol, bgBegin, bgEnd, rowCuts, shift);
+					uchar fillMeanAvgCenter = _rowMeanAvg(rcol, bgEnd, col, rowCuts, shift);
 
 					if (bgMeanAvgCenter < fillMeanAvgCenter + refImage_MeanBlockSize) {
-						line(image, Point_<int>(bgBegin, row), Point_<int>(bgEnd, row), 0, 1, 8, 0);
-						//line(refImage, Point_<int>(bgCenter.x, row), Point_<int>(bgCenter.x, row), CV_RGB(0, 255, 0), 2, 8, 0);
-						//line(refImage, Point_<int>(fillCenter.x, row), Point_<int>(fillCenter.x, row), CV_RGB(255, 255, 0), 2, 8, 0);
+						memset(icol + bgBegin, 0, bgEnd - bgBegin + 1);
 					}
 	    		}
 	    		bgBegin = col;
 	    	}
 
-	    	isBackground = *mcol >= 128 - image_EdgeDetect_Mean_C;
+	    	isBackground = isColBackground;
 	    }
 	}
 }
 
+/**
+ * Parallel task which repairs bands of the image.
+ */
+class FillMissingTask : public ParallelTask {
+public:
+	FillMissingTask(Mat &image, const Mat &means, const Mat &refMeans, int refImage_MeanBlockSize, int image_EdgeDetect_Mean_C, int rowCuts) :
+		image(image), means(means), refMeans(refMeans), refImage_MeanBlockSize(refImage_MeanBlockSize),
+		image_EdgeDetect_Mean_C(image_EdgeDetect_Mean_C), rowCuts(rowCuts) {}
+
+	void run(int from, int to) {
+		fillMissingRows(image, means, refMeans, refImage_MeanBlockSize, image_EdgeDetect_Mean_C, rowCuts, from, to);
+	}
+protected:
+	Mat &image;
+	const Mat &means;
+	const Mat &refMeans;
+	int refImage_MeanBlockSize;
+	int image_EdgeDetect_Mean_C;
+	int rowCuts;
+};
+
+/**
+ * Repairs blank places inside image which might occur after adaptive threshold.
+ *
+ * @param image Image after adaptive threshold.
+ * @param refImage Reference image used for repair. It is image before adaptive threshold.
+ * @param image_EdgeDetect_MeanBlockSize Block size of the adaptive threshold which
+ *        will be used for determining edges (places where changes 0 to 1 or 1 to 0)
+ * @param refImage_MeanBlockSize The block size that is used for calculation of means from reference image.
+ * @param image_EdgeDetect_Mean_C The transition tolerance for edges (0 to 1 or 1 to 0).
+ * @param rowCuts The number of samples which from which is calculated average mean on the row.
+ *
+ * @see rowMeanAvg
+ */
+void fillMissing(Mat &image, Mat &refImage, int image_EdgeDetect_MeanBlockSize, int refImage_MeanBlockSize, int image_EdgeDetect_Mean_C, int rowCuts) {
+	Mat refMeans;
+
+    // Calculating means for fill and background determination
+	MeanThreshold::mean(refImage, refMeans, refImage_MeanBlockSize);
+
+	fillMissingFromMeans(image, refMeans, image_EdgeDetect_MeanBlockSize, refImage_MeanBlockSize, image_EdgeDetect_Mean_C, rowCuts);
+}
+
+/**
+ * Repairs blank places inside image which might occur after adaptive threshold.
+ * Means of the reference image are already calculated (e.g. by the threshold cache).
+ *
+ * @param image Image after adaptive threshold.
+ * @param refMeans Means of the reference image (image before adaptive threshold).
+ * @param image_EdgeDetect_MeanBlockSize Block size of the adaptive threshold which
+ *        will be used for determining edges (places where changes 0 to 1 or 1 to 0)
+ * @param refImage_MeanBlockSize The block size that was used for calculation of means from reference image.
+ * @param image_EdgeDetect_Mean_C The transition tolerance for edges (0 to 1 or 1 to 0).
+ * @param rowCuts The number of samples which from which is calculated average mean on the row.
+ * @param parallel Whether to repair the horizontal bands of the image on the thread pool.
+ *
+ * @see rowMeanAvg
+ */
+void fillMissingFromMeans(Mat &image, const Mat &refMeans, int image_EdgeDetect_MeanBlockSize, int refImage_MeanBlockSize,
+		int image_EdgeDetect_Mean_C, int rowCuts, bool parallel) {
+	Mat means;
+
+	if ((image.rows == 0) || (image.cols == 0)) return;
+
+	// Calculating the means for edge detect, the whole image has to be done before any fill
+	MeanThreshold::mean(image, means, image_EdgeDetect_MeanBlockSize, parallel);
+
+	// Rows are independent, fills are written only inside their row
+	FillMissingTask task(image, means, refMeans, refImage_MeanBlockSize, image_EdgeDetect_Mean_C, rowCuts);
+	if (parallel) {
+		ThreadPool *threadPool = ThreadPool::getInstance();
+		int chunks = threadPool->getThreadsCount() * FILL_MISSING_CHUNKS_PER_THREAD;
+		threadPool->parallelFor(0, image.rows, (image.rows + chunks - 1) / chunks, task);
+	} else {
+		task.run(0, image.rows);
+	}
+}
+
 } /* namespace barcodes */
@@ -20,6 +20,7 @@
 #ifndef MISCELLANEOUS_H_
 #define MISCELLANEOUS_H_
 
+#include <stdint.h>
 #include <opencv2/core/core.hpp>
 
 namespace barcodes {
@@ -43,6 +44,16 @@ void calcBinarizedHistogram(Mat &image, Mat &contourMask, MatND &hist);
  */
 Mat getPerspectiveTransform(vector<Point> &corners, Size resultSize);
 
+/**
+ * Returns transformation matrix for perspective transformation.
+ * Corners are in the subpixel precision.
+ *
+ * @param corners Four points of the perspective projection, should be ordered from top right and clockwise.
+ * @param resultSize Result size for transformation.
+ * @return Transformation matrix for perspective transformation.
+ */
+Mat getPerspectiveTransform(vector<Point2f> &corners, Size resultSize);
+
 /**
  * Returns transformation matrix for perspective transformation.
  *
@@ -52,6 +63,16 @@ Mat getPerspectiveTransform(vector<Point> &corners, Size resultSize);
  */
 Mat getPerspectiveTransform(vector<Point> &srcCorners, vector<Point> &dstCorners);
 
+/**
+ * Returns transformation matrix for perspective transformation.
+ * Corners are in the subpixel precision.
+ *
+ * @param srcCorners Four points of the source projection, should be ordered from top right and clockwise.
+ * @param dstCorners Four points of the destination projection, should be ordered from top right and clockwise.
+ * @return Transformation matrix for perspective transformation.
+ */
+Mat getPerspectiveTransform(vector<Point2f> &srcCorners, vector<Point2f> &dstCorners);
+
 /**
  * Applies perspective transformation.
  *
@@ -65,6 +86,19 @@ Mat getPerspectiveTransform(vector<Point> &srcCorners, vector<Point> &dstCorners
  */
 Mat warpPerspective(Mat &image, vector<Point> &corners, bool sortCorners = false, Size resultSize = Size(-1,-1));
 
+/**
+ * Applies perspective transformation. Corners are in the subpixel precision.
+ *
+ * @param image Image to be transformed.
+ * @param corners Four points of the perspective projection, should be
+ *                ordered from top right and clockwise.
+ * @param sortCorners If points are not ordered, it can be done by
+ *        specifying true here. The result image but miggt be rotated then.
+ * @param resultSize Result size for transformation.
+ * @return Warped image.
+ */
+Mat warpPerspective(Mat &image, vector<Point2f> &corners, bool sortCorners = false, Size resultSize = Size(-1,-1));
+
 /**
  * Matches two binarized images for exact match.
  *
@@ -75,6 +109,25 @@ Mat warpPerspective(Mat &image, vector<Point> &corners, bool sortCorners = false
  */
 double exactMatch(Mat &mat, Mat &tmpl, Mat &diff);
 
+/**
+ * Packs the binarized image (0 and 255 values) to one bit per pixel,
+ * every row is packed into one 64-bit word (at most 64 columns).
+ *
+ * @param image Binarized image.
+ * @param packed Output packed rows.
+ */
+void packBinarized(const Mat &image, vector<uint64_t> &packed);
+
+/**
+ * Matches two packed binarized images for exact match.
+ *
+ * @param packed Packed image against which should be done template match.
+ * @param packedTmpl Packed template used for matching.
+ * @param cols Number of the columns of the packed images.
+ * @return The ratio of the different pixels.
+ */
+double exactMatchPacked(const vector<uint64_t> &packed, const vector<uint64_t> &packedTmpl, int cols);
+
 /**
  * Finds match inside an image.
  *
@@ -116,5 +169,23 @@ uchar rowMeanAvg(Mat &means, int row, int from, int to, int rowCuts);
  */
 void fillMissing(Mat &image, Mat &refImage, int image_EdgeDetect_MeanBlockSize, int refImage_MeanBlockSize, int image_EdgeDetect_Mean_C, int rowCuts);
 
+/**
+ * Repairs blank places inside image which might occur after adaptive threshold.
+ * Means of the reference image are already calculated (e.g. by the threshold cache).
+ *
+ * @param image Image after adaptive threshold.
+ * @param refMeans Means of the reference image (image before adaptive threshold).
+ * @param image_EdgeDetect_MeanBlockSize Block size of the adaptive threshold which
+ *        will be used for determining edges (places where changes 0 to 1 or 1 to 0)
+ * @param refImage_MeanBlockSize The block size that was used for calculation of means from reference image.
+ * @param image_EdgeDetect_Mean_C The transition tolerance for edges (0 to 1 or 1 to 0).
+ * @param rowCuts The number of samples which from which is calculated average mean on the row.
+ * @param parallel Whether to repair the horizontal bands of the image on the thread pool.
+ *
+ * @see rowMeanAvg
+ */
+void fillMissingFromMeans(Mat &image, const Mat &refMeans, int image_EdgeDetect_MeanBlockSize, int refImage_MeanBlockSize,
+		int image_EdgeDetect_Mean_C, int rowCuts, bool parallel = false);
+
 } /* namespace barcodes */
 #endif /* MISCELLANEOUS_H_ */
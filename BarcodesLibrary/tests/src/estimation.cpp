@@ -0,0 +1,150 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       estimation.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Compares the estimated background/fill and contour/hull filters
+//             with the mask counts on the rotated and scaled images for every
+//             distance.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file estimation.cpp
+ *
+ * @brief Compares the estimated background/fill and contour/hull filters
+ *        with the mask counts on the rotated and scaled images for every
+ *        distance. Detector confirms the estimates by the masks, so it is enough
+ *        when the estimates accept every contour accepted by the masks.
+ * @author agent agent(at)local
+ */
+
+#include <iostream>
+#include <string>
+#include <dirent.h>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <barlib/barcodes/qr/QrBarcode.h>
+
+using namespace barcodes;
+
+#define ROTATION_STEP       5
+#define SCALES_COUNT        3
+
+const double SCALES[SCALES_COUNT] = {1.0, 0.5, 0.3};
+
+/**
+ * Exposes the filters of the detector.
+ */
+class EstimationDetector : public QrDetector {
+public:
+	using QrDetector::isNestedMark;
+	using QrDetector::isLightContour;
+	using QrDetector::estimatePixelCount;
+	using QrDetector::estimateLightPixelCount;
+	using QrDetector::estimateDarkPixelCount;
+	using QrDetector::countMaskPixels;
+	using QrDetector::QR_MARK_BG_FILL_RATIO_MIN;
+	using QrDetector::QR_MARK_BG_FILL_RATIO_MAX;
+	using QrDetector::QR_MARK_CONVEX_CONTOUR_MATCH;
+};
+
+/**
+ * Tests the background/fill and contour/hull ratios.
+ */
+bool acceptRatios(double contourFill, double bgFill, double hullFill) {
+	if ((contourFill - bgFill < 1) || (bgFill < 1)) return false;
+
+	double bgFillRatio = contourFill / bgFill;
+	if ((bgFillRatio > EstimationDetector::QR_MARK_BG_FILL_RATIO_MAX) || (bgFillRatio < EstimationDetector::QR_MARK_BG_FILL_RATIO_MIN)) return false;
+	return contourFill / hullFill >= EstimationDetector::QR_MARK_CONVEX_CONTOUR_MATCH;
+}
+
+/**
+ * Compares the filters of all nested contours of the binarized image.
+ *
+ * @return Number of the contours accepted by the masks and rejected by the estimates.
+ */
+int compareFilters(Mat &binarized, int &tested, int &accepted, int &estimatedOnly) {
+	vector<vector<Point> > contours;
+	vector<Vec4i> hierarchy;
+	Mat contoursImage = binarized.clone();
+	findContours(contoursImage, contours, hierarchy, CV_RETR_TREE, CV_CHAIN_APPROX_SIMPLE);
+
+	int failed = 0;
+	for (unsigned int i = 0; i < contours.size(); i++) {
+		if ((contours[i].size() < 4) || !EstimationDetector::isNestedMark(contours, hierarchy, i)) continue;
+
+		bool inverted = EstimationDetector::isLightContour(hierarchy, i);
+		Rect boxRect = minAreaRect(Mat(contours[i])).boundingRect();
+		if ((boxRect.width * 2 > binarized.cols) || (boxRect.height * 2 > binarized.rows)) continue;
+
+		vector<Point> hull;
+		convexHull(Mat(contours[i]), hull);
+
+		double contourFill = EstimationDetector::estimatePixelCount(contours[i], true);
+		double bgFill = (inverted)? EstimationDetector::estimateDarkPixelCount(contours, hierarchy, i)
+				: EstimationDetector::estimateLightPixelCount(contours, hierarchy, i);
+		bool estimated = acceptRatios(contourFill, bgFill, EstimationDetector::estimatePixelCount(hull, true));
+
+		int darkCount, lightCount, hullDarkCount, hullLightCount;
+		EstimationDetector::countMaskPixels(binarized, contours[i], boxRect, darkCount, lightCount);
+		EstimationDetector::countMaskPixels(binarized, hull, boxRect, hullDarkCount, hullLightCount);
+		bool masked = acceptRatios(darkCount + lightCount, (inverted)? darkCount : lightCount, hullDarkCount + hullLightCount);
+
+		tested++;
+		if (masked) accepted++;
+		if (masked && !estimated) failed++;
+		if (estimated && !masked) estimatedOnly++;
+	}
+
+	return failed;
+}
+
+int main() {
+	int distances[] = {QrDetector::FLAG_DISTANCE_NEAR, QrDetector::FLAG_DISTANCE_MEDIUM,
+			QrDetector::FLAG_DISTANCE_FAR, QrDetector::FLAG_DISTANCE_FAR_FAR};
+	const char *distancesNames[] = {"NEAR", "MEDIUM", "FAR", "FAR_FAR"};
+	int failed = 0;
+
+	DIR *dir;
+	struct dirent *ent;
+	dir = opendir("img/detection");
+	if (dir != NULL) {
+		while ((ent = readdir(dir)) != NULL) {
+			if (*ent->d_name == '.') continue;
+			Image image = Image::fromFileGrayscale(string("img/detection/") + string(ent->d_name));
+
+			for (int scale = 0; scale < SCALES_COUNT; scale++) {
+
+				// Border keeps the rotated finder patterns inside the image
+				Mat scaled, padded;
+				resize(image, scaled, Size(), SCALES[scale], SCALES[scale], INTER_AREA);
+				int border = max(scaled.cols, scaled.rows) / 4;
+				copyMakeBorder(scaled, padded, border, border, border, border, BORDER_CONSTANT, Scalar(255));
+
+				for (unsigned int i = 0; i < sizeof(distances) / sizeof(int); i++) {
+					int tested = 0, accepted = 0, estimatedOnly = 0, distanceFailed = 0;
+
+					for (int angle = 0; angle <= 90; angle += ROTATION_STEP) {
+						Point2f center(padded.cols / 2.0, padded.rows / 2.0);
+						Mat rotated, rotation = getRotationMatrix2D(center, angle, 1.0);
+						warpAffine(padded, rotated, rotation, padded.size(), INTER_LINEAR, BORDER_CONSTANT, Scalar(255));
+
+						Mat binarized = QrDetector::binarize(rotated, QrDetector::FLAG_ADAPT_THRESH | distances[i]);
+						distanceFailed += compareFilters(binarized, tested, accepted, estimatedOnly);
+					}
+
+					std::cout << string(ent->d_name) << " " << SCALES[scale] << " " << distancesNames[i] << ": contours " << tested
+							<< ", accepted by the masks " << accepted << ", rejected by the estimates " << distanceFailed
+							<< ", accepted only by the estimates " << estimatedOnly << endl;
+					failed += distanceFailed;
+				}
+			}
+		}
+		closedir(dir);
+	}
+
+	return (failed == 0)? 0 : 1;
+}
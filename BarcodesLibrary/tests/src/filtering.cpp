@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       filtering.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Compares filtering of the close marks with the former
+//             filtering loop on random mark sets.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file filtering.cpp
+ *
+ * @brief Compares filtering of the close marks with the former
+ *        filtering loop on random mark sets. The former loop removed also
+ *        the mark which had removed some mark after the first one, so the results
+ *        are compared only on the sets where this does not happen.
+ * @author agent agent(at)local
+ */
+
+#include <iostream>
+#include <cstdlib>
+
+#include <barlib/barcodes/qr/QrBarcode.h>
+#include <barlib/common/Vector2D.h>
+
+using namespace barcodes;
+
+#define SETS_COUNT          10000
+#define MAX_MARKS_COUNT     12
+#define MIN_DISTANCE        0.2
+
+/**
+ * Former filtering of the marks, kept as it was.
+ */
+void filterFormer(DetectedMarks &detectedMarks, double centerPointsMinDistance) {
+
+	vector<DetectedMark>::iterator iter, iter2;
+
+	for (iter = detectedMarks.begin(); iter != detectedMarks.end(); iter++) {
+		// Centers are calculated as a centers of bounding rectangles.
+		RotatedRect refMarkBox = minAreaRect(Mat(iter->points));
+		for (iter2 = detectedMarks.begin(); iter2 != detectedMarks.end(); ) {
+			RotatedRect markBox = minAreaRect(Mat(iter2->points));
+			Vector2D centerDiff(refMarkBox.center, markBox.center);
+
+			if ((iter != iter2)
+				&& (fabs(centerDiff.dx) / (double)refMarkBox.boundingRect().width < centerPointsMinDistance)
+				&& (fabs(centerDiff.dy) / (double)refMarkBox.boundingRect().height < centerPointsMinDistance)
+			)  { // This mark is too close, filter it
+					iter2 = detectedMarks.erase(iter2);
+					iter = detectedMarks.begin();
+			} else {
+				iter2++;
+			}
+		}
+	}
+}
+
+/**
+ * Tests whether the mark is too close to the reference mark, the same condition as of the filtering.
+ */
+bool isClose(const DetectedMark &refMark, const DetectedMark &mark, double centerPointsMinDistance) {
+	RotatedRect refMarkBox = minAreaRect(Mat(refMark.points));
+	RotatedRect markBox = minAreaRect(Mat(mark.points));
+	Vector2D centerDiff(refMarkBox.center, markBox.center);
+
+	return (fabs(centerDiff.dx) / (double)refMarkBox.boundingRect().width < centerPointsMinDistance)
+		&& (fabs(centerDiff.dy) / (double)refMarkBox.boundingRect().height < centerPointsMinDistance);
+}
+
+/**
+ * Tests whether the former filtering removes only the marks close to the first mark.
+ * Any other removal restarted the former loop, which removed the reference mark too.
+ */
+bool removesOnlyByFirst(const DetectedMarks &detectedMarks, double centerPointsMinDistance) {
+	DetectedMarks kept;
+	kept.push_back(detectedMarks[0]);
+	for (unsigned int i = 1; i < detectedMarks.size(); i++) {
+		if (!isClose(detectedMarks[0], detectedMarks[i], centerPointsMinDistance)) kept.push_back(detectedMarks[i]);
+	}
+
+	for (unsigned int i = 0; i < kept.size(); i++) {
+		for (unsigned int j = 0; j < kept.size(); j++) {
+			if ((i != j) && isClose(kept[i], kept[j], centerPointsMinDistance)) return false;
+		}
+	}
+	return true;
+}
+
+/**
+ * Creates mark as the square, near-duplicates of the first mark
+ * with a different size are created often.
+ */
+DetectedMark randomMark(const DetectedMarks &detectedMarks) {
+	DetectedMark mark;
+	int x, y, size = 8 + rand() % 60;
+
+	if (!detectedMarks.empty() && (rand() % 2)) {
+		const DetectedMark &original = detectedMarks[0];
+		x = original.points[0].x + rand() % 9 - 4;
+		y = original.points[0].y + rand() % 9 - 4;
+	} else {
+		x = rand() % 400;
+		y = rand() % 400;
+	}
+
+	mark.points.push_back(Point(x, y));
+	mark.points.push_back(Point(x + size, y));
+	mark.points.push_back(Point(x + size, y + size));
+	mark.points.push_back(Point(x, y + size));
+	return mark;
+}
+
+int main() {
+	int failed = 0, compared = 0;
+	srand(1);
+
+	for (int i = 0; i < SETS_COUNT; i++) {
+		DetectedMarks detectedMarks;
+		int count = 1 + rand() % MAX_MARKS_COUNT;
+		for (int j = 0; j < count; j++) {
+			detectedMarks.push_back(randomMark(detectedMarks));
+		}
+		if (!removesOnlyByFirst(detectedMarks, MIN_DISTANCE)) continue;
+
+		DetectedMarks filtered = detectedMarks;
+		DetectedMarks filteredFormer = detectedMarks;
+		filtered.filter(MIN_DISTANCE);
+		filterFormer(filteredFormer, MIN_DISTANCE);
+
+		bool same = filtered.size() == filteredFormer.size();
+		for (unsigned int j = 0; same && (j < filtered.size()); j++) {
+			same = filtered[j].points == filteredFormer[j].points;
+		}
+		if (!same) failed++;
+		compared++;
+	}
+
+	std::cout << "Filtered mark sets different from the former filtering: " << failed << " / " << compared << endl;
+	return ((failed == 0) && (compared > 0))? 0 : 1;
+}
@@ -0,0 +1,95 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       scanline.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Compares the centers of the finder patterns found by the scanlines
+//             with the centers found by the contours for every distance.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file scanline.cpp
+ *
+ * @brief Compares the centers of the finder patterns found by the scanlines
+ *        with the centers found by the contours for every distance.
+ * @author agent agent(at)local
+ */
+
+#include <iostream>
+#include <string>
+#include <cmath>
+#include <dirent.h>
+
+#include <barlib/barcodes/qr/QrBarcode.h>
+#include <barlib/barcodes/qr/QrScanlineFinder.h>
+
+using namespace barcodes;
+
+#define CENTER_TOLERANCE    0.1
+
+/**
+ * Exposes the minimal size of the finder pattern.
+ */
+class ScanlineDetector : public QrDetector {
+public:
+	using QrDetector::QR_MARK_MINIMAL_SIZE_NORMAL;
+};
+
+/**
+ * Returns whether every scanline mark has the contour mark with the close center.
+ *
+ * @return Number of the scanline marks without the contour mark.
+ */
+int compareCenters(DetectedMarks &scanlineMarks, DetectedMarks &contourMarks) {
+	int failed = 0;
+	for (unsigned int i = 0; i < scanlineMarks.size(); i++) {
+		RotatedRect box = minAreaRect(Mat(scanlineMarks[i].points));
+		double tolerance = max(box.size.width, box.size.height) * CENTER_TOLERANCE;
+
+		bool found = false;
+		for (unsigned int j = 0; (j < contourMarks.size()) && !found; j++) {
+			Point2f diff = minAreaRect(Mat(contourMarks[j].points)).center - box.center;
+			found = sqrt(diff.x * diff.x + diff.y * diff.y) <= tolerance;
+		}
+
+		if (!found) failed++;
+	}
+
+	return failed;
+}
+
+int main() {
+	int distances[] = {QrDetector::FLAG_DISTANCE_NEAR, QrDetector::FLAG_DISTANCE_MEDIUM,
+			QrDetector::FLAG_DISTANCE_FAR, QrDetector::FLAG_DISTANCE_FAR_FAR};
+	const char *distancesNames[] = {"NEAR", "MEDIUM", "FAR", "FAR_FAR"};
+	int failed = 0;
+
+	DIR *dir;
+	struct dirent *ent;
+	dir = opendir("img/detection");
+	if (dir != NULL) {
+		while ((ent = readdir(dir)) != NULL) {
+			if (*ent->d_name == '.') continue;
+			Image image = Image::fromFileGrayscale(string("img/detection/") + string(ent->d_name));
+
+			for (unsigned int i = 0; i < sizeof(distances) / sizeof(int); i++) {
+				int flags = QrDetector::FLAG_ADAPT_THRESH | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL | distances[i];
+
+				DetectedMarks scanlineMarks, contourMarks;
+				Mat binarized = QrDetector::binarize(image, flags);
+				QrScanlineFinder::find(binarized, scanlineMarks, ScanlineDetector::QR_MARK_MINIMAL_SIZE_NORMAL);
+				QrBarcode::detect(image, contourMarks, flags);
+
+				int distanceFailed = compareCenters(scanlineMarks, contourMarks);
+				std::cout << string(ent->d_name) << " " << distancesNames[i] << ": scanline marks " << scanlineMarks.size()
+						<< ", contour marks " << contourMarks.size() << ", not matching " << distanceFailed << endl;
+				failed += distanceFailed;
+			}
+		}
+		closedir(dir);
+	}
+
+	return (failed == 0)? 0 : 1;
+}
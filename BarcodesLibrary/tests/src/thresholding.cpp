@@ -0,0 +1,104 @@
+///////////////////////////////////////////////////////////////////////////////
+// Project:    Barcodes Library
+// File:       thresholding.cpp
+// Date:       October 2026
+// Author:     agent
+// E-mail:     agent(at)local
+//
+// Brief:      Compares adaptive mean thresholds of the library (serial and
+//             parallel) with the OpenCV's adaptiveThreshold for all supported
+//             instructions.
+///////////////////////////////////////////////////////////////////////////////
+
+/**
+ * @file thresholding.cpp
+ *
+ * @brief Compares adaptive mean thresholds of the library (serial and
+ *        parallel) with the OpenCV's adaptiveThreshold for all supported
+ *        instructions.
+ * @author agent agent(at)local
+ */
+
+#include <iostream>
+#include <string>
+#include <dirent.h>
+#include <opencv2/imgproc/imgproc.hpp>
+
+#include <barlib/common/Image.h>
+#include <barlib/common/MeanThreshold.h>
+#include <barlib/common/ThresholdCache.h>
+
+using namespace barcodes;
+
+const char *INSTRUCTIONS_NAMES[] = {"SCALAR", "SSE2", "AVX2"};
+
+/**
+ * Compares thresholds of the image for one block size and constant.
+ *
+ * @return Number of the different pixels.
+ */
+int compareThresholds(Mat &image, int blockSize, int mean_C) {
+	Mat expected, expectedMean, binarized, parallelBinarized;
+	ThresholdCache thresholdCache(image);
+	ThresholdCache parallelThresholdCache(image, true);
+
+	adaptiveThreshold(image, expected, 255, ADAPTIVE_THRESH_MEAN_C, THRESH_BINARY, blockSize, mean_C);
+	boxFilter(image, expectedMean, image.type(), Size(blockSize, blockSize), Point(-1,-1), true, BORDER_REPLICATE);
+	MeanThreshold::threshold(image, binarized, blockSize, mean_C);
+	MeanThreshold::threshold(image, parallelBinarized, blockSize, mean_C, true);
+
+	return countNonZero(expected != binarized) + countNonZero(expected != parallelBinarized)
+			+ countNonZero(expected != thresholdCache.adaptiveThreshold(blockSize, mean_C))
+			+ countNonZero(expected != parallelThresholdCache.adaptiveThreshold(blockSize, mean_C))
+			+ countNonZero(expectedMean != thresholdCache.mean(blockSize))
+			+ countNonZero(expectedMean != parallelThresholdCache.mean(blockSize));
+}
+
+int main() {
+	int blockSizes[] = {3, 5, 13, 31, 101, 1001};
+	int constants[] = {-300, -5, 0, 7, 43, 300};
+	Size sizes[] = {Size(1, 1), Size(17, 3), Size(64, 64), Size(333, 211)};
+	vector<Mat> images;
+
+	RNG rng;
+	for (unsigned int i = 0; i < sizeof(sizes) / sizeof(Size); i++) {
+		Mat image(sizes[i], CV_8UC1);
+		rng.fill(image, RNG::UNIFORM, 0, 256);
+		images.push_back(image);
+		images.push_back(image > 127);
+	}
+
+	DIR *dir;
+	struct dirent *ent;
+	dir = opendir ("img/detection");
+	if (dir != NULL) {
+		while ((ent = readdir (dir)) != NULL) {
+			if (*ent->d_name != '.') {
+				images.push_back(Image::fromFileGrayscale(string("img/detection/") + string(ent->d_name)));
+			}
+		}
+		closedir (dir);
+	}
+
+	int failed = 0;
+	for (int instructions = MeanThreshold::INSTRUCTIONS_SCALAR; instructions <= MeanThreshold::INSTRUCTIONS_AVX2; instructions++) {
+		if (!MeanThreshold::setInstructions(instructions)) {
+			std::cout << "Instructions " << INSTRUCTIONS_NAMES[instructions] << " are not supported" << endl;
+			continue;
+		}
+
+		int differences = 0;
+		for (unsigned int i = 0; i < images.size(); i++) {
+			for (unsigned int j = 0; j < sizeof(blockSizes) / sizeof(int); j++) {
+				for (unsigned int k = 0; k < sizeof(constants) / sizeof(int); k++) {
+					differences += compareThresholds(images[i], blockSizes[j], constants[k]);
+				}
+			}
+		}
+
+		std::cout << "Thresholds " << INSTRUCTIONS_NAMES[instructions] << ": " << string((differences == 0)? "OK" : "DIFFERENT") << endl;
+		if (differences != 0) failed++;
+	}
+
+	return failed;
+}
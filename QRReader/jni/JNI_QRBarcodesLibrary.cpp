@@ -20,6 +20,7 @@
 
 #include <jni.h>
 #include <barlib/debug.h>
+#include <barlib/common/FrameGate.h>
 #include <barlib/barcodes/qr/QrBarcode.h>
 
 #include "wrappers/jDetectedMark.h"
@@ -32,8 +33,15 @@ using namespace barcodes;
 
 #define DEBUG_TAG "JNI_QRBarcodesLibrary.cpp"
 
-static Image img_detect;
-static Image img_rgb_detect;
+/**
+ * Gate of the preview frames, frames are detected from one thread only.
+ */
+static FrameGate detectGate;
+
+/**
+ * Marks of the last detected preview frame, they are returned for the unchanged frames.
+ */
+static DetectedMarks lastDetectedMarks;
 
 extern "C" {
 	/**
@@ -43,6 +51,8 @@ extern "C" {
 		DEBUG_PRINT(DEBUG_TAG, "===== DETECT CALL =====");
 		QrBarcode barcode;
 		DetectedMarks detectedMarks;
+		Image img_detect;
+		Image img_rgb_detect;
 		jImage _jImage(env, image);
 		_jImage(img_detect);
 
@@ -50,8 +60,18 @@ extern "C" {
 
 		if (Image::convertColorFormat(img_detect, img_rgb_detect, IMAGE_COLOR_GRAYSCALE)) {
 			DEBUG_WRITE_IMAGE(std::string("detect_image.jpg") , img_detect);
-			// Detects the finder patterns in the image
-			barcode.detect(img_rgb_detect, detectedMarks, QrDetector::FLAG_DISTANCE_MEDIUM | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_HIGH | QrDetector::FLAG_USE_HIERARCHY);
+
+			// Unchanged frames reuse the last marks, blurred frames would not give any marks
+			int gateResult = detectGate.check(img_rgb_detect);
+			DEBUG_PRINT(DEBUG_TAG, "Gate: %d, sharpness: %f, difference: %f", gateResult, detectGate.getSharpness(), detectGate.getDifference());
+
+			if (gateResult == FrameGate::FRAME_ACCEPTED) {
+				// Detects the finder patterns in the image
+				barcode.detect(img_rgb_detect, detectedMarks, QrDetector::FLAG_DISTANCE_MEDIUM | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_HIGH | QrDetector::FLAG_USE_HIERARCHY);
+				lastDetectedMarks = detectedMarks;
+			} else if (gateResult == FrameGate::FRAME_UNCHANGED) {
+				detectedMarks = lastDetectedMarks;
+			}
 
 			// Allocating memory for java array
 			int arrLength = detectedMarks.size();
@@ -83,13 +103,14 @@ extern "C" {
 		jImage _jImage(env, image);
 		Image img_decode = _jImage;
 		DataSegments dataSegments;
+		DecodeContext context;
 
 		DEBUG_PRINT(DEBUG_TAG, "Image size: [%d : %d]", img_decode.cols, img_decode.rows);
 
 		if (img_decode.convertColorFormat(IMAGE_COLOR_GRAYSCALE)) {
 
 			// Decodes the QR code from the image
-			barcode.decode(img_decode, dataSegments, QrDetector::FLAG_ADAPT_THRESH | QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR
+			barcode.decode(img_decode, dataSegments, context, QrDetector::FLAG_ADAPT_THRESH | QrDetector::FLAG_QR_MARK_OUTER_FLOOD_FILL_REPAIR
 					| QrDetector::DISTANCE_FLAGS | QrDetector::FLAG_QR_MARK_MATCH_TOLERANCE_NORMAL);
 
 			// If there are any data segments, return found QR code image
@@ -99,7 +120,7 @@ extern "C" {
 		        param[0]=CV_IMWRITE_JPEG_QUALITY;
 		        param[1]=40;
 
-		        imencode(".jpg", QrDecoder::getInstance()->lastProcessedImage(), outImageBuffer,param);
+		        imencode(".jpg", context.lastProcessedImage(), outImageBuffer,param);
 
 		        jImage(env, image).setData(&outImageBuffer[0], outImageBuffer.size());
 			}